@@ -3,6 +3,13 @@ TEMPLATE = subdirs
 SUBDIRS = libs \
     bin/scenarist-desktop.pro
 
+#
+# Нагрузочный тест собирается по запросу: qmake CONFIG+=benchmark
+#
+benchmark {
+    SUBDIRS += bin/scenarist-benchmark.pro
+}
+
 TRANSLATIONS += bin/scenarist-core/Resources/Translations/Scenarist_ru.ts \
     bin/scenarist-core/Resources/Translations/Scenarist_es.ts \
     bin/scenarist-core/Resources/Translations/Scenarist_fr.ts \
@@ -0,0 +1,57 @@
+#-------------------------------------------------
+#
+# Нагрузочный тест основных сценариев работы с проектом
+#
+# Собирается из тех же исходников, что и программа, но вместо интерфейса
+# генерирует синтетический проект и замеряет операции над ним
+#
+#-------------------------------------------------
+
+include(scenarist-desktop.pro)
+
+TARGET = ScenaristBenchmark
+
+CONFIG += console
+macx: CONFIG -= app_bundle
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../build/Debug/bin/scenarist-benchmark
+} else {
+    DESTDIR = $$PWD/../../build/Release/bin/scenarist-benchmark
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+#
+# Замер памяти процесса в Windows
+#
+win32: LIBS += -lpsapi
+#
+
+#
+# Точку входа программы заменяем точкой входа теста
+#
+SOURCES -= scenarist-desktop/main.cpp
+
+SOURCES += \
+    scenarist-benchmark/main.cpp \
+    scenarist-benchmark/BenchmarkRunner.cpp \
+    scenarist-benchmark/ScriptGenerator.cpp
+
+HEADERS += \
+    scenarist-benchmark/BenchmarkRunner.h \
+    scenarist-benchmark/ScriptGenerator.h
+
+win32:RC_FILE =
+win32-msvc*:QMAKE_LFLAGS_WINDOWS =
+macx {
+    ICON =
+    QMAKE_INFO_PLIST =
+}
@@ -0,0 +1,378 @@
+#include "BenchmarkRunner.h"
+
+#include <BusinessLayer/Export/DocxExporter.h>
+#include <BusinessLayer/Export/FdxExporter.h>
+#include <BusinessLayer/Export/FountainExporter.h>
+#include <BusinessLayer/Export/PdfExporter.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioDocument.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioTextDocument.h>
+#include <BusinessLayer/Statistics/StatisticsFacade.h>
+#include <BusinessLayer/Tools/CompareScriptVersionsTool.h>
+
+#include <DataLayer/Database/Database.h>
+#include <DataLayer/DataStorageLayer/ResearchStorage.h>
+#include <DataLayer/DataStorageLayer/ScenarioChangeStorage.h>
+#include <DataLayer/DataStorageLayer/ScenarioStorage.h>
+#include <DataLayer/DataStorageLayer/StorageFacade.h>
+
+#include <Domain/Scenario.h>
+#include <Domain/ScenarioChange.h>
+
+#include <ManagementLayer/Project/ProjectsManager.h>
+#include <ManagementLayer/Scenario/ScenarioManager.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QSharedPointer>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextStream>
+#include <QWidget>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_MAC
+#include <mach/mach.h>
+#endif
+
+using Benchmark::BenchmarkRunner;
+using Benchmark::Measurement;
+using DataStorageLayer::StorageFacade;
+using DatabaseLayer::Database;
+
+namespace {
+    /**
+     * @brief Имя файла проекта в папке теста
+     */
+    const QString PROJECT_FILE_NAME = "benchmark.kitsp";
+
+    /**
+     * @brief Шаг между номерами блоков, в которые вносятся правки
+     * @note Простое число, чтобы правки равномерно распределялись по всему сценарию
+     */
+    const int EDIT_BLOCKS_STEP = 7919;
+
+    /**
+     * @brief Процессорное время, затраченное процессом, мс
+     */
+    static double processCpuTime() {
+#ifdef Q_OS_WIN
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+            return 0;
+        }
+        const auto toMsecs = [] (const FILETIME& _time) {
+            return ((static_cast<quint64>(_time.dwHighDateTime) << 32) | _time.dwLowDateTime) / 10000.;
+        };
+        return toMsecs(kernelTime) + toMsecs(userTime);
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.
+                + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.;
+#endif
+    }
+
+    /**
+     * @brief Текущий объём резидентной памяти процесса, КБ
+     */
+    static qint64 currentRss() {
+#if defined(Q_OS_WIN)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return 0;
+        }
+        return counters.WorkingSetSize / 1024;
+#elif defined(Q_OS_MAC)
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count)
+            != KERN_SUCCESS) {
+            return 0;
+        }
+        return info.resident_size / 1024;
+#else
+        QFile statm("/proc/self/statm");
+        if (!statm.open(QIODevice::ReadOnly)) {
+            return 0;
+        }
+        const QList<QByteArray> values = statm.readAll().split(' ');
+        if (values.size() < 2) {
+            return 0;
+        }
+        return values.at(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+#endif
+    }
+
+    /**
+     * @brief Сбросить отметку пикового объёма резидентной памяти процесса до текущего объёма
+     * @return Удалось ли сбросить, ядро позволяет это сделать только в линуксе
+     */
+    static bool resetPeakRss() {
+#ifdef Q_OS_LINUX
+        QFile clearRefs("/proc/self/clear_refs");
+        return clearRefs.open(QIODevice::WriteOnly | QIODevice::Unbuffered)
+                && clearRefs.write("5") == 1;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Пиковый объём резидентной памяти процесса с момента сброса отметки, КБ
+     */
+    static qint64 peakRss() {
+#ifdef Q_OS_LINUX
+        QFile status("/proc/self/status");
+        if (!status.open(QIODevice::ReadOnly)) {
+            return 0;
+        }
+        const QByteArray peakPrefix = "VmHWM:";
+        for (const QByteArray& line : status.readAll().split('\n')) {
+            if (line.startsWith(peakPrefix)) {
+                return line.mid(peakPrefix.size()).simplified().split(' ').first().toLongLong();
+            }
+        }
+#endif
+        return 0;
+    }
+}
+
+
+BenchmarkRunner::BenchmarkRunner(const QString& _workDirPath, const GeneratorParameters& _parameters,
+    int _edits) :
+    m_workDirPath(_workDirPath),
+    m_parameters(_parameters),
+    m_edits(_edits)
+{
+}
+
+QVector<Measurement> BenchmarkRunner::run()
+{
+    m_measurements.clear();
+
+    QDir::root().mkpath(m_workDirPath);
+    const QDir workDir(m_workDirPath);
+    const QString projectPath = workDir.absoluteFilePath(PROJECT_FILE_NAME);
+
+    //
+    // Генерируем проект
+    //
+    measure("Generate project", [this, &projectPath] {
+        return ScriptGenerator::createProject(projectPath, m_parameters);
+    });
+    if (!m_measurements.last().isSucceed) {
+        return m_measurements;
+    }
+
+    //
+    // Открываем его заново управляющим сценарием, как при открытии проекта в программе
+    //
+    QWidget window;
+    ManagementLayer::ProjectsManager projectsManager(nullptr);
+    ManagementLayer::ScenarioManager scenarioManager(nullptr, &window);
+    measure("Load", [&projectsManager, &scenarioManager, &projectPath] {
+        StorageFacade::clearStorages();
+        Database::closeCurrentFile();
+        if (!projectsManager.setCurrentProject(projectPath)) {
+            return false;
+        }
+        scenarioManager.loadCurrentProject();
+        scenarioManager.loadCurrentProjectSettings(projectPath);
+        StorageFacade::researchStorage()->all();
+        return !Database::hasError();
+    });
+    if (!m_measurements.last().isSucceed) {
+        return m_measurements;
+    }
+    //
+    // ... большой сценарий догружается по частям в цикле событий, а тем временем срабатывает
+    //     автосохранение. Проект, который пользователь не трогал, при этом должен остаться
+    //     неизменённым: иначе программа предложит сохранить его при закрытии, а сохранение
+    //     прервёт догрузку и запишет лишнее изменение в историю
+    //
+    measure("Load remaining parts", [&scenarioManager] {
+        bool isProjectChanged = false;
+        const QMetaObject::Connection changedConnection =
+                QObject::connect(&scenarioManager, &ManagementLayer::ScenarioManager::scenarioChanged,
+                                 [&isProjectChanged] { isProjectChanged = true; });
+        const Domain::ScenarioChange* lastChange = StorageFacade::scenarioChangeStorage()->last();
+        QMetaObject::invokeMethod(&scenarioManager, "aboutSaveScenarioChanges", Qt::DirectConnection);
+        while (scenarioManager.isScenarioLoading()) {
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+            QMetaObject::invokeMethod(&scenarioManager, "aboutSaveScenarioChanges", Qt::DirectConnection);
+        }
+        QObject::disconnect(changedConnection);
+        return !isProjectChanged
+                && StorageFacade::scenarioChangeStorage()->last() == lastChange;
+    });
+    BusinessLogic::ScenarioDocument& script = *scenarioManager.scenario();
+    const QString loadedXml = script.save();
+
+    //
+    // Полное сохранение сценария
+    //
+    measure("Save", [&script] {
+        Database::transaction();
+        script.scenario()->setText(script.save());
+        StorageFacade::scenarioStorage()->storeScenario(script.scenario());
+        Database::commit();
+        return !Database::hasError();
+    });
+
+    //
+    // Автосохранение: правки сохраняются в историю изменений так же часто, как в программе,
+    // а затем проект сохраняется целиком
+    //
+    QStringList patches;
+    measure(QString("Autosave (%1 edits)").arg(m_edits), [this, &script, &scenarioManager, &patches] {
+        QTextDocument* document = script.document();
+        for (int edit = 0; edit < m_edits; ++edit) {
+            QTextCursor cursor(document->findBlockByNumber((edit * EDIT_BLOCKS_STEP) % document->blockCount()));
+            cursor.movePosition(QTextCursor::EndOfBlock);
+            cursor.insertText(" edited");
+
+            //
+            // ... в программе изменения сохраняет таймер управляющего сценарием, здесь вызываем его слот сами
+            //
+            const Domain::ScenarioChange* lastChange = StorageFacade::scenarioChangeStorage()->last();
+            QMetaObject::invokeMethod(&scenarioManager, "aboutSaveScenarioChanges", Qt::DirectConnection);
+            const Domain::ScenarioChange* change = StorageFacade::scenarioChangeStorage()->last();
+            if (change != nullptr
+                && change != lastChange) {
+                patches.append(change->redoPatch());
+            }
+        }
+
+        Database::transaction();
+        scenarioManager.saveCurrentProject();
+        Database::commit();
+        return !Database::hasError();
+    });
+
+    //
+    // Экспорт во все поддерживаемые форматы
+    //
+    const QVector<QPair<QString, QSharedPointer<BusinessLogic::AbstractExporter>>> exporters = {
+        { "pdf", QSharedPointer<BusinessLogic::AbstractExporter>(new BusinessLogic::PdfExporter) },
+        { "docx", QSharedPointer<BusinessLogic::AbstractExporter>(new BusinessLogic::DocxExporter) },
+        { "fdx", QSharedPointer<BusinessLogic::AbstractExporter>(new BusinessLogic::FdxExporter) },
+        { "fountain", QSharedPointer<BusinessLogic::AbstractExporter>(new BusinessLogic::FountainExporter) }
+    };
+    for (const auto& exporter : exporters) {
+        BusinessLogic::ExportParameters exportParameters;
+        exportParameters.isScript = true;
+        exportParameters.filePath = workDir.absoluteFilePath(QString("benchmark.%1").arg(exporter.first));
+        exportParameters.printPagesNumbers = true;
+        exportParameters.printScenesNumbers = true;
+        exportParameters.saveReviewMarks = true;
+        QFile::remove(exportParameters.filePath);
+        measure(QString("Export %1").arg(exporter.first.toUpper()), [&script, &exporter, &exportParameters] {
+            exporter.second->exportTo(&script, exportParameters);
+            return QFileInfo(exportParameters.filePath).size() > 0;
+        });
+    }
+
+    //
+    // Отчёты статистики
+    //
+    const QVector<QPair<QString, BusinessLogic::StatisticsParameters::ReportType>> reports = {
+        { "summary", BusinessLogic::StatisticsParameters::SummaryReport },
+        { "scenes", BusinessLogic::StatisticsParameters::SceneReport },
+        { "locations", BusinessLogic::StatisticsParameters::LocationReport },
+        { "cast", BusinessLogic::StatisticsParameters::CastReport },
+        { "characters", BusinessLogic::StatisticsParameters::CharacterReport }
+    };
+    for (const auto& report : reports) {
+        BusinessLogic::StatisticsParameters statisticsParameters;
+        statisticsParameters.type = BusinessLogic::StatisticsParameters::Report;
+        statisticsParameters.reportType = report.second;
+        measure(QString("Statistics %1 report").arg(report.first), [&script, &statisticsParameters] {
+            return !BusinessLogic::StatisticsFacade::makeReport(script.document(), statisticsParameters).isEmpty();
+        });
+    }
+
+    //
+    // Сравнение версии сценария до правок с текущей
+    //
+    const QString editedXml = script.save();
+    measure("Compare versions", [&loadedXml, &editedXml] {
+        return !BusinessLogic::CompareScriptVersionsTool::compareScripts(loadedXml, editedXml).isEmpty();
+    });
+
+    //
+    // Наложение правок на сценарий в исходном состоянии, как при синхронизации
+    //
+    Domain::Scenario originalScenario(Domain::Identifier(), QString(), QString(), false);
+    originalScenario.setText(loadedXml);
+    BusinessLogic::ScenarioDocument patchedScript(nullptr);
+    patchedScript.load(&originalScenario);
+    measure(QString("Apply patches (%1)").arg(patches.size()), [&patchedScript, &patches] {
+        patchedScript.document()->applyPatches(patches);
+        return !patches.isEmpty();
+    });
+
+    scenarioManager.closeCurrentProject();
+    projectsManager.closeCurrentProject();
+    StorageFacade::clearStorages();
+    Database::closeCurrentFile();
+
+    return m_measurements;
+}
+
+QString BenchmarkRunner::report(const QVector<Measurement>& _measurements)
+{
+    QString result;
+    QTextStream out(&result);
+    out << QString("%1 %2 %3 %4 %5\n")
+           .arg("Operation", -32).arg("Wall, ms", 12).arg("CPU, ms", 12).arg("RSS delta, KB", 14)
+           .arg("Peak growth, KB", 16);
+    for (const Measurement& measurement : _measurements) {
+        if (measurement.isSucceed) {
+            out << QString("%1 %2 %3 %4 %5\n")
+                   .arg(measurement.operation, -32)
+                   .arg(measurement.wallTime, 12, 'f', 1)
+                   .arg(measurement.cpuTime, 12, 'f', 1)
+                   .arg(measurement.rssDelta, 14)
+                   .arg(measurement.peakRssGrowth >= 0 ? QString::number(measurement.peakRssGrowth) : "n/a", 16);
+        } else {
+            out << QString("%1 %2\n").arg(measurement.operation, -32).arg("FAILED", 12);
+        }
+    }
+    out.flush();
+    return result;
+}
+
+void BenchmarkRunner::measure(const QString& _operation, std::function<bool()> _func)
+{
+    Measurement measurement;
+    measurement.operation = _operation;
+
+    const qint64 rssStart = currentRss();
+    const bool canMeasurePeakRss = resetPeakRss();
+    const double cpuTimeStart = processCpuTime();
+    QElapsedTimer timer;
+    timer.start();
+    measurement.isSucceed = _func();
+    measurement.wallTime = timer.nsecsElapsed() / 1000000.;
+    measurement.cpuTime = processCpuTime() - cpuTimeStart;
+    measurement.rssDelta = currentRss() - rssStart;
+    if (canMeasurePeakRss) {
+        measurement.peakRssGrowth = peakRss() - rssStart;
+    }
+
+    m_measurements.append(measurement);
+}
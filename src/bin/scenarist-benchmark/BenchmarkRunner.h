@@ -0,0 +1,106 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include "ScriptGenerator.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+
+namespace Benchmark
+{
+    /**
+     * @brief Замер одной операции
+     */
+    struct Measurement {
+        /**
+         * @brief Название операции
+         */
+        QString operation;
+
+        /**
+         * @brief Выполнилась ли операция успешно
+         */
+        bool isSucceed = true;
+
+        /**
+         * @brief Время выполнения, мс
+         */
+        double wallTime = 0;
+
+        /**
+         * @brief Процессорное время процесса за время выполнения, мс
+         */
+        double cpuTime = 0;
+
+        /**
+         * @brief Изменение объёма резидентной памяти процесса за время выполнения, КБ
+         */
+        qint64 rssDelta = 0;
+
+        /**
+         * @brief Превышение пикового объёма резидентной памяти за время выполнения над объёмом до него, КБ
+         * @note Отрицательное значение, если на платформе нельзя сбросить отметку пикового объёма
+         */
+        qint64 peakRssGrowth = -1;
+    };
+
+
+    /**
+     * @brief Прогон нагрузочного теста основных сценариев работы с проектом
+     * @note Загрузка и автосохранение выполняются управляющим сценарием так же, как в программе,
+     *       но с невидимым окном, а остальные операции напрямую через слой бизнес-логики и хранилища,
+     *       в том же порядке, в котором их вызывают управляющие программы
+     */
+    class BenchmarkRunner
+    {
+    public:
+        /**
+         * @param _workDirPath - папка для файла проекта и результатов экспорта
+         * @param _edits - количество правок для замера автосохранения и наложения патчей
+         */
+        BenchmarkRunner(const QString& _workDirPath, const GeneratorParameters& _parameters, int _edits);
+
+        /**
+         * @brief Выполнить все замеры
+         */
+        QVector<Measurement> run();
+
+        /**
+         * @brief Сформировать таблицу с результатами замеров
+         */
+        static QString report(const QVector<Measurement>& _measurements);
+
+    private:
+        /**
+         * @brief Замерить выполнение операции
+         */
+        void measure(const QString& _operation, std::function<bool()> _func);
+
+    private:
+        /**
+         * @brief Папка для файлов теста
+         */
+        const QString m_workDirPath;
+
+        /**
+         * @brief Параметры генерируемого проекта
+         */
+        const GeneratorParameters m_parameters;
+
+        /**
+         * @brief Количество правок
+         */
+        const int m_edits;
+
+        /**
+         * @brief Результаты замеров
+         */
+        QVector<Measurement> m_measurements;
+    };
+}
+
+#endif // BENCHMARKRUNNER_H
@@ -0,0 +1,309 @@
+#include "ScriptGenerator.h"
+
+#include <BusinessLayer/Import/FountainImporter.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioDocument.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioModel.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioTextDocument.h>
+
+#include <DataLayer/Database/Database.h>
+#include <DataLayer/DataStorageLayer/ResearchStorage.h>
+#include <DataLayer/DataStorageLayer/ScenarioStorage.h>
+#include <DataLayer/DataStorageLayer/StorageFacade.h>
+
+#include <Domain/Research.h>
+#include <Domain/Scenario.h>
+
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QPixmap>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextBlock>
+#include <QTextCharFormat>
+#include <QTextCursor>
+#include <QTextStream>
+
+#include <random>
+
+using Benchmark::GeneratorParameters;
+using Benchmark::ScriptGenerator;
+using BusinessLogic::ScenarioBlockStyle;
+using DataStorageLayer::StorageFacade;
+using Domain::Research;
+
+namespace {
+    /**
+     * @brief Слоги, из которых составляются имена персонажей и локаций
+     */
+    const QStringList NAME_SYLLABLES = {
+        "A", "BE", "DO", "KA", "LI", "MA", "NO", "RI", "SA", "TO", "VE", "ZU"
+    };
+
+    /**
+     * @brief Словарь для формирования текста
+     */
+    const QStringList WORDS = {
+        "the", "door", "opens", "slowly", "and", "light", "falls", "across", "an", "empty",
+        "room", "she", "looks", "at", "him", "for", "a", "long", "moment", "before", "turning",
+        "away", "rain", "hits", "window", "somewhere", "far", "off", "dog", "barks", "we",
+        "never", "talked", "about", "it", "again", "you", "know", "what", "I", "mean", "nothing",
+        "stays", "same", "forever", "car", "stops", "outside", "footsteps", "on", "stairs"
+    };
+
+    /**
+     * @brief Переходы между сценами
+     */
+    const QStringList TRANSITIONS = { "CUT TO:", "DISSOLVE TO:", "SMASH CUT TO:" };
+
+    /**
+     * @brief Каждая какая сцена заканчивается переходом
+     */
+    const int TRANSITION_EVERY_SCENES = 10;
+
+    /**
+     * @brief Количество сцен, приходящихся на одну локацию
+     */
+    const int SCENES_PER_LOCATION = 8;
+
+    /**
+     * @brief Размер изображения в галерее разработки
+     */
+    const QSize IMAGE_SIZE(640, 480);
+
+    /**
+     * @brief Уникальное имя из слогов по номеру
+     */
+    static QString syllablesName(int _index) {
+        QString name;
+        int index = _index;
+        do {
+            name.append(NAME_SYLLABLES.at(index % NAME_SYLLABLES.size()));
+            index /= NAME_SYLLABLES.size();
+        } while (index > 0);
+        //
+        // ... слишком короткие имена удлиняем, чтобы они не совпадали со служебными словами
+        //
+        if (name.length() < 3) {
+            name.append("RO");
+        }
+        return name;
+    }
+
+    /**
+     * @brief Генератор текста
+     */
+    class TextGenerator
+    {
+    public:
+        explicit TextGenerator(unsigned _seed) :
+            m_engine(_seed)
+        {
+        }
+
+        /**
+         * @brief Случайное число в диапазоне [_from, _to]
+         */
+        int number(int _from, int _to) {
+            return std::uniform_int_distribution<int>(_from, _to)(m_engine);
+        }
+
+        /**
+         * @brief Предложение из заданного количества слов
+         */
+        QString sentence(int _minWords, int _maxWords) {
+            const int wordsCount = number(_minWords, _maxWords);
+            QStringList words;
+            for (int wordIndex = 0; wordIndex < wordsCount; ++wordIndex) {
+                words.append(WORDS.at(number(0, WORDS.size() - 1)));
+            }
+            QString result = words.join(" ");
+            result[0] = result.at(0).toUpper();
+            return result + ".";
+        }
+
+        /**
+         * @brief Абзац из нескольких предложений
+         */
+        QString paragraph(int _sentences) {
+            QStringList sentences;
+            for (int sentenceIndex = 0; sentenceIndex < _sentences; ++sentenceIndex) {
+                sentences.append(sentence(4, 14));
+            }
+            return sentences.join(" ");
+        }
+
+    private:
+        std::mt19937 m_engine;
+    };
+
+    /**
+     * @brief Отметить часть блоков редакторскими заметками
+     */
+    static void addReviewMarks(QTextDocument* _document, int _percent, TextGenerator& _generator) {
+        if (_percent <= 0) {
+            return;
+        }
+
+        QTextCharFormat reviewFormat;
+        reviewFormat.setProperty(ScenarioBlockStyle::PropertyIsReviewMark, true);
+        reviewFormat.setBackground(QColor("#fff59d"));
+
+        QTextCursor cursor(_document);
+        cursor.beginEditBlock();
+        for (QTextBlock block = _document->begin(); block.isValid(); block = block.next()) {
+            if (block.length() < 2
+                || _generator.number(1, 100) > _percent) {
+                continue;
+            }
+
+            const int from = _generator.number(0, block.length() - 2);
+            const int length = _generator.number(1, block.length() - 1 - from);
+            cursor.setPosition(block.position() + from);
+            cursor.setPosition(block.position() + from + length, QTextCursor::KeepAnchor);
+            cursor.mergeCharFormat(reviewFormat);
+        }
+        cursor.endEditBlock();
+    }
+
+    /**
+     * @brief Сформировать разработку проекта
+     */
+    static void storeResearch(const GeneratorParameters& _parameters, TextGenerator& _generator) {
+        for (int characterIndex = 0; characterIndex < _parameters.characters; ++characterIndex) {
+            Research* character = StorageFacade::researchStorage()->storeCharacter(syllablesName(characterIndex));
+            character->setDescription(_generator.paragraph(3));
+            StorageFacade::researchStorage()->updateCharacter(character);
+        }
+
+        const int locations = qMax(1, _parameters.scenes / SCENES_PER_LOCATION);
+        for (int locationIndex = 0; locationIndex < locations; ++locationIndex) {
+            StorageFacade::researchStorage()->storeLocation(QString("%1 ROOM").arg(syllablesName(locationIndex)));
+        }
+
+        if (_parameters.researchItems > 0) {
+            Research* folder =
+                    StorageFacade::researchStorage()->storeResearch(nullptr, Research::Folder, 0, "Notes");
+            for (int itemIndex = 0; itemIndex < _parameters.researchItems; ++itemIndex) {
+                Research* text = StorageFacade::researchStorage()->storeResearch(
+                                     folder, Research::Text, itemIndex, QString("Note %1").arg(itemIndex + 1));
+                text->setDescription(_generator.paragraph(_generator.number(5, 40)));
+                StorageFacade::researchStorage()->updateResearch(text);
+            }
+        }
+
+        if (_parameters.images > 0) {
+            Research* gallery =
+                    StorageFacade::researchStorage()->storeResearch(nullptr, Research::ImagesGallery, 1, "Mood board");
+            for (int imageIndex = 0; imageIndex < _parameters.images; ++imageIndex) {
+                //
+                // Шум сжимается плохо, поэтому размер изображения в базе близок к реальным фотографиям
+                //
+                QImage image(IMAGE_SIZE, QImage::Format_RGB32);
+                for (int y = 0; y < image.height(); ++y) {
+                    QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+                    for (int x = 0; x < image.width(); ++x) {
+                        line[x] = qRgb(_generator.number(0, 255), _generator.number(0, 255), _generator.number(0, 255));
+                    }
+                }
+                Research* imageResearch = StorageFacade::researchStorage()->storeResearch(
+                                              gallery, Research::Image, imageIndex, QString("Image %1").arg(imageIndex + 1));
+                imageResearch->setImage(QPixmap::fromImage(image));
+                StorageFacade::researchStorage()->updateResearch(imageResearch);
+            }
+        }
+    }
+}
+
+
+QString ScriptGenerator::fountainText(const GeneratorParameters& _parameters)
+{
+    TextGenerator generator(_parameters.seed);
+    const int characters = qMax(1, _parameters.characters);
+    const int locations = qMax(1, _parameters.scenes / SCENES_PER_LOCATION);
+
+    QString text;
+    QTextStream out(&text);
+    for (int sceneIndex = 0; sceneIndex < _parameters.scenes; ++sceneIndex) {
+        const bool isInterior = generator.number(0, 1) == 0;
+        out << (isInterior ? "INT. " : "EXT. ")
+            << syllablesName(generator.number(0, locations - 1)) << " ROOM - "
+            << (generator.number(0, 1) == 0 ? "DAY" : "NIGHT") << "\n\n";
+
+        out << generator.paragraph(generator.number(1, 4)) << "\n\n";
+
+        for (int dialogueIndex = 0; dialogueIndex < _parameters.dialoguesPerScene; ++dialogueIndex) {
+            out << syllablesName(generator.number(0, characters - 1)) << "\n";
+            if (generator.number(1, 5) == 1) {
+                const QString parenthetical = generator.sentence(1, 3).toLower();
+                out << "(" << parenthetical.left(parenthetical.length() - 1) << ")\n";
+            }
+            out << generator.paragraph(generator.number(1, 3)) << "\n\n";
+
+            if (generator.number(1, 3) == 1) {
+                out << generator.paragraph(1) << "\n\n";
+            }
+        }
+
+        if ((sceneIndex + 1) % TRANSITION_EVERY_SCENES == 0) {
+            out << "> " << TRANSITIONS.at(generator.number(0, TRANSITIONS.size() - 1)) << "\n\n";
+        }
+    }
+    out.flush();
+
+    return text;
+}
+
+bool ScriptGenerator::createProject(const QString& _projectPath, const GeneratorParameters& _parameters)
+{
+    //
+    // Сценарий формируем через импорт из файла Fountain
+    //
+    QTemporaryDir tempDir;
+    const QString fountainPath = QDir(tempDir.path()).absoluteFilePath("script.fountain");
+    {
+        QFile fountainFile(fountainPath);
+        if (!fountainFile.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+        fountainFile.write(fountainText(_parameters).toUtf8());
+    }
+    BusinessLogic::ImportParameters importParameters;
+    importParameters.filePath = fountainPath;
+    const QString scriptXml = BusinessLogic::FountainImporter().importScript(importParameters);
+    if (scriptXml.isEmpty()) {
+        return false;
+    }
+
+    //
+    // Создаём новую базу данных проекта
+    //
+    if (QFile::exists(_projectPath)) {
+        QFile::remove(_projectPath);
+    }
+    DatabaseLayer::Database::setCurrentFile(_projectPath);
+
+    //
+    // Загружаем сценарий в документ так же, как это делает импорт в программе, дополняем
+    // редакторскими заметками и сохраняем
+    //
+    TextGenerator generator(_parameters.seed + 1);
+    Domain::Scenario* scenario = StorageFacade::scenarioStorage()->current();
+    BusinessLogic::ScenarioDocument script(nullptr);
+    script.load(scenario);
+    script.document()->insertFromMime(0, scriptXml);
+    addReviewMarks(script.document(), _parameters.reviewMarksPercent, generator);
+
+    DatabaseLayer::Database::transaction();
+    scenario->setText(script.save());
+    if (_parameters.withCardsScheme) {
+        scenario->setScheme(script.model()->simpleScheme());
+    }
+    StorageFacade::scenarioStorage()->storeScenario(scenario);
+    storeResearch(_parameters, generator);
+    DatabaseLayer::Database::commit();
+
+    return !DatabaseLayer::Database::hasError();
+}
@@ -0,0 +1,77 @@
+#ifndef SCRIPTGENERATOR_H
+#define SCRIPTGENERATOR_H
+
+#include <QString>
+
+
+namespace Benchmark
+{
+    /**
+     * @brief Параметры генерируемого проекта
+     */
+    struct GeneratorParameters {
+        /**
+         * @brief Количество сцен
+         */
+        int scenes = 1000;
+
+        /**
+         * @brief Количество персонажей
+         */
+        int characters = 40;
+
+        /**
+         * @brief Количество реплик в сцене
+         */
+        int dialoguesPerScene = 6;
+
+        /**
+         * @brief Доля блоков с редакторскими заметками, в процентах
+         */
+        int reviewMarksPercent = 5;
+
+        /**
+         * @brief Количество текстовых документов разработки
+         */
+        int researchItems = 100;
+
+        /**
+         * @brief Количество изображений в галерее разработки
+         */
+        int images = 20;
+
+        /**
+         * @brief Сохранять ли схему карточек
+         */
+        bool withCardsScheme = true;
+
+        /**
+         * @brief Начальное значение генератора случайных чисел
+         */
+        unsigned seed = 1;
+    };
+
+
+    /**
+     * @brief Генератор синтетических проектов для нагрузочного тестирования
+     * @note Текст сценария формируется в формате Fountain и загружается тем же импортёром,
+     *       что используется в программе, поэтому генератор не зависит от внутреннего
+     *       формата хранения сценария
+     */
+    class ScriptGenerator
+    {
+    public:
+        /**
+         * @brief Сформировать текст сценария в формате Fountain
+         */
+        static QString fountainText(const GeneratorParameters& _parameters);
+
+        /**
+         * @brief Создать проект в заданном файле и сделать его текущим
+         * @return Удалось ли сформировать сценарий
+         */
+        static bool createProject(const QString& _projectPath, const GeneratorParameters& _parameters);
+    };
+}
+
+#endif // SCRIPTGENERATOR_H
@@ -0,0 +1,79 @@
+#include "BenchmarkRunner.h"
+#include "ScriptGenerator.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QTextStream>
+
+
+int main(int argc, char *argv[])
+{
+    //
+    // Тест работает без интерфейса, поэтому по умолчанию не требует дисплея
+    //
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication application(argc, argv);
+    //
+    // ... отдельное имя приложения, чтобы не затрагивать настройки и данные программы
+    //
+    application.setOrganizationName("DimkaNovikov labs.");
+    application.setOrganizationDomain("dimkanovikov.pro");
+    application.setApplicationName("Scenarist Benchmark");
+
+    //
+    // Настроим параметры теста
+    //
+    const Benchmark::GeneratorParameters defaultParameters;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates a synthetic project and measures core workflows on it.");
+    parser.addHelpOption();
+    const QCommandLineOption workDirOption("work-dir", "Folder for the project and exported files.", "path",
+                                           QDir::temp().absoluteFilePath("scenarist-benchmark"));
+    const QCommandLineOption scenesOption("scenes", "Number of scenes.", "count",
+                                          QString::number(defaultParameters.scenes));
+    const QCommandLineOption charactersOption("characters", "Number of characters.", "count",
+                                              QString::number(defaultParameters.characters));
+    const QCommandLineOption dialoguesOption("dialogues", "Number of dialogues per scene.", "count",
+                                             QString::number(defaultParameters.dialoguesPerScene));
+    const QCommandLineOption reviewMarksOption("review-marks", "Percent of blocks with review marks.", "percent",
+                                               QString::number(defaultParameters.reviewMarksPercent));
+    const QCommandLineOption researchOption("research", "Number of research text documents.", "count",
+                                            QString::number(defaultParameters.researchItems));
+    const QCommandLineOption imagesOption("images", "Number of research images.", "count",
+                                          QString::number(defaultParameters.images));
+    const QCommandLineOption noCardsOption("no-cards", "Do not store the cards scheme.");
+    const QCommandLineOption editsOption("edits", "Number of edits for autosave and patch apply.", "count", "200");
+    const QCommandLineOption seedOption("seed", "Random generator seed.", "number",
+                                        QString::number(defaultParameters.seed));
+    parser.addOptions({ workDirOption, scenesOption, charactersOption, dialoguesOption, reviewMarksOption,
+                        researchOption, imagesOption, noCardsOption, editsOption, seedOption });
+    parser.process(application);
+
+    Benchmark::GeneratorParameters parameters;
+    parameters.scenes = parser.value(scenesOption).toInt();
+    parameters.characters = parser.value(charactersOption).toInt();
+    parameters.dialoguesPerScene = parser.value(dialoguesOption).toInt();
+    parameters.reviewMarksPercent = parser.value(reviewMarksOption).toInt();
+    parameters.researchItems = parser.value(researchOption).toInt();
+    parameters.images = parser.value(imagesOption).toInt();
+    parameters.withCardsScheme = !parser.isSet(noCardsOption);
+    parameters.seed = parser.value(seedOption).toUInt();
+
+    //
+    // Выполняем замеры и выводим результат
+    //
+    Benchmark::BenchmarkRunner runner(parser.value(workDirOption), parameters, parser.value(editsOption).toInt());
+    const QVector<Benchmark::Measurement> measurements = runner.run();
+    QTextStream(stdout) << Benchmark::BenchmarkRunner::report(measurements);
+
+    for (const Benchmark::Measurement& measurement : measurements) {
+        if (!measurement.isSucceed) {
+            return 1;
+        }
+    }
+    return 0;
+}
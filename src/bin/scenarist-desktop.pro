@@ -83,6 +83,16 @@ DEPENDPATH += $$PWD/../libs/qgumboparser
 PRE_TARGETDEPS += $$PWD/../libs/qgumboparser
 #
 
+#
+# Подключаем библилотеку BlockDiff
+#
+LIBS += -L$$DESTDIR/../../libs/blockdiff/ -lblockdiff
+
+INCLUDEPATH += $$PWD/../libs/blockdiff
+DEPENDPATH += $$PWD/../libs/blockdiff
+PRE_TARGETDEPS += $$PWD/../libs/blockdiff
+#
+
 unix {
 LIBS += -lz
 }
@@ -346,6 +356,7 @@ SOURCES += \
     scenarist-desktop/UserInterfaceLayer/Application/MenuView.cpp \
     scenarist-core/3rd_party/Widgets/ClickableLabel/ClickableLabel.cpp \
     scenarist-desktop/ManagementLayer/MenuManager.cpp \
+    scenarist-desktop/ManagementLayer/Tracing/Tracer.cpp \
     scenarist-core/3rd_party/Widgets/ClickableLabel/ClickableFrame.cpp \
     scenarist-core/BusinessLayer/Import/CeltxImporter.cpp \
     scenarist-desktop/UserInterfaceLayer/Application/AboutDialog.cpp \
@@ -368,7 +379,15 @@ SOURCES += \
     scenarist-core/BusinessLayer/Tools/CompareScriptVersionsTool.cpp \
     scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioItemDialog/ScenarioItemDialog.cpp \
     scenarist-core/3rd_party/Widgets/CircularProgressBar/CircularProgressBar.cpp \
-    scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioCards/CardsSearchWidget.cpp
+    scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioCards/CardsSearchWidget.cpp \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptNamesIndex.cpp \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptBlocksColorsUpdater.cpp \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptIndexesLoader.cpp \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptItemsIndex.cpp \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptPatchRebaser.cpp \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptProgressiveLoader.cpp \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptChronometryIndex.cpp \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptTextCountersIndex.cpp
 
 HEADERS += \
     scenarist-core/3rd_party/Helpers/XmlHelper.h \
@@ -631,6 +650,7 @@ HEADERS += \
     scenarist-desktop/UserInterfaceLayer/Application/MenuView.h \
     scenarist-core/3rd_party/Widgets/ClickableLabel/ClickableLabel.h \
     scenarist-desktop/ManagementLayer/MenuManager.h \
+    scenarist-desktop/ManagementLayer/Tracing/Tracer.h \
     scenarist-core/3rd_party/Widgets/ClickableLabel/ClickableFrame.h \
     scenarist-core/BusinessLayer/Import/CeltxImporter.h \
     scenarist-desktop/UserInterfaceLayer/Application/AboutDialog.h \
@@ -652,7 +672,15 @@ HEADERS += \
     scenarist-core/BusinessLayer/Tools/CompareScriptVersionsTool.h \
     scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioItemDialog/ScenarioItemDialog.h \
     scenarist-core/3rd_party/Widgets/CircularProgressBar/CircularProgressBar.h \
-    scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioCards/CardsSearchWidget.h
+    scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioCards/CardsSearchWidget.h \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptNamesIndex.h \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptBlocksColorsUpdater.h \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptIndexesLoader.h \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptItemsIndex.h \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptPatchRebaser.h \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptProgressiveLoader.h \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptChronometryIndex.h \
+    scenarist-desktop/ManagementLayer/Scenario/ScriptTextCountersIndex.h
 
 FORMS += \
     scenarist-desktop/UserInterfaceLayer/StartUp/StartUpView.ui \
@@ -3,14 +3,17 @@
 #include <ManagementLayer/ApplicationManager.h>
 
 #include <NetworkRequest.h>
+#include <WebCache.h>
 
 #include <DataLayer/DataStorageLayer/StorageFacade.h>
 #include <DataLayer/DataStorageLayer/SettingsStorage.h>
 
 #include <3rd_party/Helpers/StyleHelper.h>
 
+#include <QDir>
 #include <QFileOpenEvent>
 #include <QFontDatabase>
+#include <QStandardPaths>
 #include <QStyle>
 #include <QStyleFactory>
 #include <QTranslator>
@@ -44,6 +47,12 @@ Application::Application(int& _argc, char** _argv) :
     setApplicationName("Scenarist");
     setApplicationVersion("0.7.2 rc 15");
 
+    //
+    // Настроим дисковый кэш для сетевых запросов
+    //
+    WebCache::instance()->setCacheDirectory(
+                QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QDir::separator() + "WebCache");
+
     //
     // Настроим стиль отображения внешнего вида приложения
     //
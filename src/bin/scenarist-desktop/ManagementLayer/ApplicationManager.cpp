@@ -10,6 +10,7 @@
 #include "StartUp/StartUpManager.h"
 #include "Statistics/StatisticsManager.h"
 #include "Tools/ToolsManager.h"
+#include "Tracing/Tracer.h"
 
 #include <3rd_party/Helpers/RunOnce.h>
 #include <3rd_party/Helpers/TextUtils.h>
@@ -242,6 +243,11 @@ ApplicationManager::ApplicationManager(QObject* parent)
 
 ApplicationManager::~ApplicationManager()
 {
+    //
+    // Дожидаемся записи резервных копий, чтобы при выходе из программы они не оборвались на середине
+    //
+    m_backupFuture.waitForFinished();
+
     m_view->deleteLater();
 
 #ifdef Q_OS_MAC
@@ -618,6 +624,8 @@ void ApplicationManager::aboutSaveAs()
 
 void ApplicationManager::aboutSave()
 {
+    const Tracer::Span span("ApplicationManager::aboutSave");
+
     //
     // Избегаем рекурсии
     //
@@ -655,10 +663,13 @@ void ApplicationManager::aboutSave()
         //
         // Управляющие должны сохранить несохранённые данные
         //
-        DatabaseLayer::Database::transaction();
-        m_researchManager->saveResearch();
-        m_scenarioManager->saveCurrentProject();
-        DatabaseLayer::Database::commit();
+        {
+            const Tracer::Span saveSpan("Database::saveTransaction");
+            DatabaseLayer::Database::transaction();
+            m_researchManager->saveResearch();
+            m_scenarioManager->saveCurrentProject();
+            DatabaseLayer::Database::commit();
+        }
 
         //
         // Обновим информацию о последнем изменении
@@ -688,13 +699,29 @@ void ApplicationManager::aboutSave()
                 baseBackupName
                     = QString("%1 [%2]").arg(currentProject.name()).arg(currentProject.id());
             }
-            QtConcurrent::run(&m_backupHelper, &BackupHelper::saveBackup,
-                              ProjectsManager::currentProject().path(), baseBackupName);
+            //
+            // ... копирование выполняется в фоне, но только после завершения копии предыдущего
+            //     сохранения, чтобы копии последовательных сохранений не записывались одновременно
+            //
+            // ... задание не обращается к менеджеру, а получает копию помощника резервного копирования
+            //
+            const QString projectPath = ProjectsManager::currentProject().path();
+            BackupHelper backupHelper = m_backupHelper;
+            QFuture<void> previousBackup = m_backupFuture;
+            m_backupFuture = QtConcurrent::run([backupHelper, projectPath, baseBackupName, previousBackup] () mutable {
+                previousBackup.waitForFinished();
+                backupHelper.saveBackup(projectPath, baseBackupName);
+            });
         }
         //
         // А если ошибка сохранения, то делаем дополнительные проверки и работаем с пользователем
         //
         else {
+            //
+            // Изменения разработки не записались, поэтому при повторном сохранении пишем их целиком
+            //
+            m_researchManager->markAllResearchUnsaved();
+
             //
             // Если файл, в который мы пробуем сохранять изменения существует
             //
@@ -747,6 +774,7 @@ void ApplicationManager::aboutSave()
     // Для проекта из облака синхронизируем данные
     //
     if (m_projectsManager->currentProject().isRemote()) {
+        const Tracer::Span syncSpan("SynchronizationManager::workSync");
         m_synchronizationManager->aboutWorkSyncScenario();
         m_synchronizationManager->aboutWorkSyncData();
     }
@@ -765,6 +793,7 @@ void ApplicationManager::aboutStartNewVersion()
         //
         // А уж потом положим версию в базу данных
         //
+        m_scenarioManager->finishScenarioLoading();
         DataStorageLayer::StorageFacade::scriptVersionStorage()->storeScriptVersion(
             DataStorageLayer::StorageFacade::userName(), versionDialog.versionDateTime(),
             versionDialog.versionColor(), versionDialog.versionName(),
@@ -798,6 +827,8 @@ void ApplicationManager::saveCurrentProjectSettings(const QString& _projectPath)
 
 void ApplicationManager::aboutLoad(const QString& _fileName)
 {
+    const Tracer::Span span("ApplicationManager::aboutLoad");
+
     //
     // Если нужно сохранить проект
     //
@@ -1488,6 +1519,7 @@ void ApplicationManager::aboutSyncClosedWithError(int _errorCode, const QString&
 void ApplicationManager::aboutImport()
 {
     m_state = ApplicationState::Importing;
+    m_scenarioManager->finishScenarioLoading();
     m_importManager->importScenario(m_scenarioManager->scenario(),
                                     m_scenarioManager->cursorPosition());
     m_researchManager->loadScenarioData();
@@ -1497,12 +1529,14 @@ void ApplicationManager::aboutImport()
 
 void ApplicationManager::aboutExport()
 {
+    m_scenarioManager->finishScenarioLoading();
     m_exportManager->exportScenario(m_scenarioManager->scenario(),
                                     m_researchManager->scenarioData());
 }
 
 void ApplicationManager::printPreviewScript()
 {
+    m_scenarioManager->finishScenarioLoading();
     m_exportManager->printPreview(m_scenarioManager->scenario(), m_researchManager->scenarioData(),
                                   ManagementLayer::ExportType::Script);
 }
@@ -1530,6 +1564,11 @@ void ApplicationManager::aboutExit()
         //
         saveViewState();
 
+        //
+        // Выгружаем трассировку, если она была включена
+        //
+        Tracer::exportChromeTrace(QString());
+
         //
         // Выходим
         //
@@ -1600,6 +1639,7 @@ void ApplicationManager::aboutShowFullscreen()
 
 void ApplicationManager::aboutPrepareScenarioForStatistics()
 {
+    m_scenarioManager->finishScenarioLoading();
     m_statisticsManager->setExportedScenario(m_scenarioManager->scenario()->document());
 }
 
@@ -1827,8 +1867,20 @@ bool ApplicationManager::saveIfNeeded()
 
 void ApplicationManager::goToEditCurrentProject(const QString& _importFilePath)
 {
+    const Tracer::Span span("ApplicationManager::goToEditCurrentProject");
+
     m_state = ApplicationState::ProjectLoading;
 
+    //
+    // Замеряем длительность этапов открытия проекта, в трассировке они охватывают вызовы управляющих
+    //
+    qint64 phaseStartNs = Tracer::nowNs();
+    auto finishPhase = [&phaseStartNs] (const char* _phase) {
+        const qint64 nowNs = Tracer::nowNs();
+        Tracer::record(_phase, phaseStartNs, nowNs - phaseStartNs);
+        phaseStartNs = nowNs;
+    };
+
     //
     // Покажем уведомление пользователю
     //
@@ -1878,6 +1930,7 @@ void ApplicationManager::goToEditCurrentProject(const QString& _importFilePath)
         m_projectsManager->setCurrentProjectSyncAvailable(SYNC_AVAILABLE);
 
         setSyncIndicator();
+        const Tracer::Span syncSpan("SynchronizationManager::prepareToFullSynchronization");
         m_synchronizationManager->prepareToFullSynchronization();
     }
 
@@ -1888,37 +1941,38 @@ void ApplicationManager::goToEditCurrentProject(const QString& _importFilePath)
     // Загружаем текст сценария
     // Это нужно делать перед синхронизацией текста
     //
+    finishPhase("Project prepared");
     m_scenarioManager->loadCurrentProject();
+    finishPhase("Script loaded");
 
     //
     // Синхронизируем проекты из облака
     //
     if (m_projectsManager->currentProject().isRemote()) {
         progress.setProgressText(QString::null, tr("Sync scenario with cloud service."));
+        const Tracer::Span syncSpan("SynchronizationManager::fullSync");
         m_synchronizationManager->aboutFullSyncScenario();
         m_synchronizationManager->aboutFullSyncData();
+        finishPhase("Project synchronized");
     }
 
-    //
-    // FIXME: Если были изменения связанные с текстом сценария перестраиваем карточки
-    //        т.к. там нет пока синхронизации
-    //
-    m_scenarioManager->rebuildCardsFromScript();
-
     //
     // Загрузить данные из файла
     // Делать это нужно после того, как все данные синхронизировались
     //
     m_researchManager->loadCurrentProject();
     m_statisticsManager->loadCurrentProject();
+    finishPhase("Research loaded");
 
     //
     // Затем импортируем данные из указанного файла, если необходимо
     //
     if (!_importFilePath.isEmpty()) {
         progress.setProgressText(tr("Import"), tr("Please wait. Import can take few minutes."));
+        m_scenarioManager->finishScenarioLoading();
         m_importManager->importScenario(m_scenarioManager->scenario(), _importFilePath);
         m_researchManager->loadScenarioData();
+        finishPhase("Data imported");
     }
 
     //
@@ -1935,6 +1989,7 @@ void ApplicationManager::goToEditCurrentProject(const QString& _importFilePath)
     m_exportManager->loadCurrentProjectSettings(ProjectsManager::currentProject().path());
     m_toolsManager->loadCurrentProjectSettings();
     loadCurrentProjectSettings(ProjectsManager::currentProject().path());
+    finishPhase("Project settings loaded");
 
     //
     // Обновим название текущего проекта, т.к. данные о проекте теперь загружены
@@ -1960,6 +2015,7 @@ void ApplicationManager::goToEditCurrentProject(const QString& _importFilePath)
     QApplication::sendPostedEvents();
     QApplication::processEvents();
     progress.finish();
+    finishPhase("Views updated");
 
     m_state = ApplicationState::Working;
 
@@ -1974,11 +2030,16 @@ void ApplicationManager::goToEditCurrentProject(const QString& _importFilePath)
 
 void ApplicationManager::closeCurrentProject()
 {
+    const Tracer::Span span("ApplicationManager::closeCurrentProject");
+
     if (isProjectLoaded()) {
         //
         // Ожидаем завершения работы менеджера синхронизации
         //
-        m_synchronizationManager->wait();
+        {
+            const Tracer::Span syncSpan("SynchronizationManager::wait");
+            m_synchronizationManager->wait();
+        }
 
         //
         // Сохраним настройки закрываемого проекта
@@ -2023,6 +2084,11 @@ void ApplicationManager::closeCurrentProject()
     //
     DataStorageLayer::StorageFacade::clearStorages();
 
+    //
+    // Дожидаемся записи резервных копий закрываемого проекта
+    //
+    m_backupFuture.waitForFinished();
+
     //
     // Если использовалась база данных, то удалим старое соединение
     //
@@ -2034,6 +2100,7 @@ void ApplicationManager::closeCurrentProject()
     //
     // Перезапускаем работу менеджера синхронизации после ожидания и остановки
     //
+    const Tracer::Span syncSpan("SynchronizationManager::restart");
     m_synchronizationManager->restart();
 }
 
@@ -3,6 +3,7 @@
 
 #include <3rd_party/Helpers/BackupHelper.h>
 
+#include <QFuture>
 #include <QObject>
 #include <QTimer>
 
@@ -426,6 +427,11 @@ namespace ManagementLayer
          */
         BackupHelper m_backupHelper;
 
+        /**
+         * @brief Фоновое создание резервной копии последнего сохранения
+         */
+        QFuture<void> m_backupFuture;
+
         /**
          * @brief Состояние приложения в данный момент
          */
@@ -1,6 +1,7 @@
 #include "ExportManager.h"
 
 #include <ManagementLayer/Project/ProjectsManager.h>
+#include <ManagementLayer/Tracing/Tracer.h>
 
 #include <BusinessLayer/Research/ResearchModel.h>
 #include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
@@ -223,6 +224,8 @@ void ExportManager::printPreview(BusinessLogic::ScenarioDocument* _scenario,
 
 void ExportManager::loadCurrentProjectSettings(const QString& _projectPath)
 {
+    const Tracer::Span span("ExportManager::loadCurrentProjectSettings");
+
     //
     // Очистим галочки модели разработки
     //
@@ -307,6 +310,8 @@ void ExportManager::loadCurrentProjectSettings(const QString& _projectPath)
 
 void ExportManager::saveCurrentProjectSettings(const QString& _projectPath)
 {
+    const Tracer::Span span("ExportManager::saveCurrentProjectSettings");
+
     const QString projectKey = QString("projects/%1/export").arg(_projectPath);
 
     //
@@ -1,5 +1,7 @@
 #include "ImportManager.h"
 
+#include <ManagementLayer/Scenario/ScriptNamesIndex.h>
+
 #include <Domain/Research.h>
 #include <Domain/Scenario.h>
 
@@ -232,7 +234,8 @@ bool ImportManager::importScenario(BusinessLogic::ScenarioDocument* _scenario, i
         // Персонажи
         //
         {
-            const QSet<QString> characters = QSet<QString>::fromList(_scenario->findCharacters());
+            const QSet<QString> characters =
+                    ManagementLayer::ScriptNamesIndex::forDocument(_scenario->document())->characters();
 
             //
             // Определить персонажи, которых нет в тексте
@@ -271,7 +274,8 @@ bool ImportManager::importScenario(BusinessLogic::ScenarioDocument* _scenario, i
         // Локации
         //
         {
-            const QSet<QString> locations = QSet<QString>::fromList(_scenario->findLocations());
+            const QSet<QString> locations =
+                    ManagementLayer::ScriptNamesIndex::forDocument(_scenario->document())->locations();
 
             //
             // Определить локации, которых нет в тексте
@@ -1,5 +1,7 @@
 #include "ResearchManager.h"
 
+#include <ManagementLayer/Tracing/Tracer.h>
+
 #include <DataLayer/DataStorageLayer/ResearchStorage.h>
 #include <DataLayer/DataStorageLayer/ScenarioStorage.h>
 #include <DataLayer/DataStorageLayer/ScenarioDataStorage.h>
@@ -75,6 +77,8 @@ QAbstractItemModel* ResearchManager::model() const
 
 void ResearchManager::loadCurrentProject()
 {
+    const Tracer::Span span("ResearchManager::loadCurrentProject");
+
     g_isProjectLoading = true;
 
     //
@@ -97,6 +101,8 @@ void ResearchManager::loadCurrentProject()
 
 void ResearchManager::loadScenarioData()
 {
+    const Tracer::Span span("ResearchManager::loadScenarioData");
+
     m_scenarioData.insert(ScenarioData::NAME_KEY, StorageFacade::scenarioDataStorage()->name());
     m_scenarioData.insert(ScenarioData::HEADER_KEY, StorageFacade::scenarioDataStorage()->header());
     m_scenarioData.insert(ScenarioData::FOOTER_KEY, StorageFacade::scenarioDataStorage()->footer());
@@ -109,6 +115,7 @@ void ResearchManager::loadScenarioData()
     m_scenarioData.insert(ScenarioData::YEAR_KEY, StorageFacade::scenarioDataStorage()->year());
     m_scenarioData.insert(ScenarioData::LOGLINE_KEY, StorageFacade::scenarioDataStorage()->logline());
     m_scenarioData.insert(ScenarioData::SYNOPSIS_KEY, StorageFacade::scenarioDataStorage()->synopsis());
+    m_changedScenarioDataKeys.clear();
 
     if (m_view->currentResearchIndex().isValid()) {
         editResearch(m_view->currentResearchIndex());
@@ -117,6 +124,8 @@ void ResearchManager::loadScenarioData()
 
 void ResearchManager::loadCurrentProjectSettings(const QString& _projectPath)
 {
+    const Tracer::Span span("ResearchManager::loadCurrentProjectSettings");
+
     //
     // Загрузим состояние дерева
     //
@@ -133,13 +142,20 @@ void ResearchManager::loadCurrentProjectSettings(const QString& _projectPath)
 
 void ResearchManager::closeCurrentProject()
 {
+    const Tracer::Span span("ResearchManager::closeCurrentProject");
+
     m_scenarioData.clear();
+    m_changedScenarioDataKeys.clear();
+    m_changedResearch.clear();
+    m_isAllResearchChanged = false;
     m_model->clear();
     m_view->clear();
 }
 
 void ResearchManager::saveCurrentProjectSettings(const QString& _projectPath)
 {
+    const Tracer::Span span("ResearchManager::saveCurrentProjectSettings");
+
     //
     // Сохраним состояние дерева
     //
@@ -223,34 +239,59 @@ void ResearchManager::updateSettings()
 
 void ResearchManager::saveResearch()
 {
+    const Tracer::Span span("ResearchManager::saveResearch");
+
     //
     // Сохраняем данные сценария
+    // ... только изменённые с момента прошлого сохранения
     //
-    if (!m_scenarioData.isEmpty()) {
-        StorageFacade::scenarioDataStorage()->setName(m_scenarioData.value(ScenarioData::NAME_KEY));
-        StorageFacade::scenarioDataStorage()->setHeader(m_scenarioData.value(ScenarioData::HEADER_KEY));
-        StorageFacade::scenarioDataStorage()->setFooter(m_scenarioData.value(ScenarioData::FOOTER_KEY));
-        StorageFacade::scenarioDataStorage()->setSceneNumbersPrefix(m_scenarioData.value(ScenarioData::SCENE_NUMBERS_PREFIX_KEY));
-        StorageFacade::scenarioDataStorage()->setSceneStartNumber(m_scenarioData.value(ScenarioData::SCENE_START_NUMBER_KEY));
-        StorageFacade::scenarioDataStorage()->setAdditionalInfo(m_scenarioData.value(ScenarioData::ADDITIONAL_INFO_KEY));
-        StorageFacade::scenarioDataStorage()->setGenre(m_scenarioData.value(ScenarioData::GENRE_KEY));
-        StorageFacade::scenarioDataStorage()->setAuthor(m_scenarioData.value(ScenarioData::AUTHOR_KEY));
-        StorageFacade::scenarioDataStorage()->setContacts(m_scenarioData.value(ScenarioData::CONTACTS_KEY));
-        StorageFacade::scenarioDataStorage()->setYear(m_scenarioData.value(ScenarioData::YEAR_KEY));
-        StorageFacade::scenarioDataStorage()->setLogline(m_scenarioData.value(ScenarioData::LOGLINE_KEY));
-        StorageFacade::scenarioDataStorage()->setSynopsis(m_scenarioData.value(ScenarioData::SYNOPSIS_KEY));
+    if (!m_changedScenarioDataKeys.isEmpty()) {
+        using DataStorageLayer::ScenarioDataStorage;
+        static const QMap<QString, void (*)(ScenarioDataStorage*, const QString&)> setters = {
+            { ScenarioData::NAME_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setName(_value); } },
+            { ScenarioData::HEADER_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setHeader(_value); } },
+            { ScenarioData::FOOTER_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setFooter(_value); } },
+            { ScenarioData::SCENE_NUMBERS_PREFIX_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setSceneNumbersPrefix(_value); } },
+            { ScenarioData::SCENE_START_NUMBER_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setSceneStartNumber(_value); } },
+            { ScenarioData::ADDITIONAL_INFO_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setAdditionalInfo(_value); } },
+            { ScenarioData::GENRE_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setGenre(_value); } },
+            { ScenarioData::AUTHOR_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setAuthor(_value); } },
+            { ScenarioData::CONTACTS_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setContacts(_value); } },
+            { ScenarioData::YEAR_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setYear(_value); } },
+            { ScenarioData::LOGLINE_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setLogline(_value); } },
+            { ScenarioData::SYNOPSIS_KEY, [] (ScenarioDataStorage* _storage, const QString& _value) { _storage->setSynopsis(_value); } }
+        };
+        for (const QString& key : m_changedScenarioDataKeys) {
+            if (setters.contains(key)) {
+                setters.value(key)(StorageFacade::scenarioDataStorage(), m_scenarioData.value(key));
+            }
+        }
+        m_changedScenarioDataKeys.clear();
     }
 
     //
     // Сохраняем элементы разработки
+    // ... только изменённые, проверяя их наличие в хранилище, т.к. после изменения элемент мог быть удалён
     //
-    foreach (Domain::DomainObject* researchObject,
-             DataStorageLayer::StorageFacade::researchStorage()->all()->toList()) {
-        Domain::Research* research = dynamic_cast<Domain::Research*>(researchObject);
-        DataStorageLayer::StorageFacade::researchStorage()->updateResearch(research);
+    if (m_isAllResearchChanged || !m_changedResearch.isEmpty()) {
+        foreach (Domain::DomainObject* researchObject,
+                 DataStorageLayer::StorageFacade::researchStorage()->all()->toList()) {
+            Domain::Research* research = dynamic_cast<Domain::Research*>(researchObject);
+            if (m_isAllResearchChanged || m_changedResearch.contains(research)) {
+                DataStorageLayer::StorageFacade::researchStorage()->updateResearch(research);
+            }
+        }
+        m_changedResearch.clear();
+        m_isAllResearchChanged = false;
     }
 }
 
+void ResearchManager::markAllResearchUnsaved()
+{
+    m_changedScenarioDataKeys = m_scenarioData.keys().toSet();
+    m_isAllResearchChanged = true;
+}
+
 void ResearchManager::setCommentOnly(bool _isCommentOnly)
 {
     m_view->setCommentOnly(_isCommentOnly);
@@ -395,7 +436,9 @@ void ResearchManager::addResearch(const QModelIndex& _selectedItemIndex, int _ty
             // Обновляем порядок сортировки
             //
             for (int row = 0; row < parentResearchItem->childCount(); ++row) {
-                parentResearchItem->childAt(row)->research()->setSortOrder(row);
+                Research* research = parentResearchItem->childAt(row)->research();
+                research->setSortOrder(row);
+                markResearchChanged(research);
             }
 
             QModelIndex indexForSelect;
@@ -698,9 +741,11 @@ void ResearchManager::showNavigatorContextMenu(const QModelIndex& _index, const
             refreshResearchSubtree(_index);
         } else if (toggledAction == removeColorAction) {
             researchItem->research()->setColor(QColor());
+            markResearchChanged(researchItem->research());
         } else {
             if (colorsPane->currentColor().isValid()) {
                 researchItem->research()->setColor(colorsPane->currentColor());
+                markResearchChanged(researchItem->research());
             }
         }
     }
@@ -715,10 +760,18 @@ void ResearchManager::updateScenarioData(const QString& _key, const QString& _va
         && m_scenarioData.contains(_key)
         && m_scenarioData.value(_key) != _value) {
         m_scenarioData.insert(_key, _value);
+        m_changedScenarioDataKeys.insert(_key);
         emit researchChanged();
     }
 }
 
+void ResearchManager::markResearchChanged(Domain::Research* _research)
+{
+    if (_research != nullptr) {
+        m_changedResearch.insert(_research);
+    }
+}
+
 void ResearchManager::initView()
 {
     m_view->setResearchModel(m_model);
@@ -728,6 +781,11 @@ void ResearchManager::initView()
 void ResearchManager::initConnections()
 {
     connect(m_model, &ResearchModel::itemMoved, this, [this] (const QModelIndex& _index) {
+        //
+        // При перемещении меняются родитель и порядок сортировки сразу многих элементов,
+        // поэтому сохраняем все
+        //
+        m_isAllResearchChanged = true;
         m_view->selectItem(_index);
         emit researchChanged();
     });
@@ -836,6 +894,7 @@ void ResearchManager::initConnections()
             if (StorageFacade::researchStorage()->hasCharacter(_name)) {
                 Research* mainCharacter = StorageFacade::researchStorage()->character(_name);
                 mainCharacter->addDescription(m_currentResearch->description());
+                markResearchChanged(mainCharacter);
                 removeResearchItem(m_currentResearchItem);
             }
             //
@@ -843,6 +902,7 @@ void ResearchManager::initConnections()
             //
             else {
                 m_currentResearch->setName(newName);
+                markResearchChanged(m_currentResearch);
                 m_model->updateItem(m_model->itemForIndex(m_view->currentResearchIndex()));
             }
             emit researchChanged();
@@ -854,6 +914,7 @@ void ResearchManager::initConnections()
             && m_currentResearch->type() == Research::Character) {
             auto* researchCharacter = dynamic_cast<ResearchCharacter*>(m_currentResearch);
             researchCharacter->setRealName(_name);
+            markResearchChanged(m_currentResearch);
             emit researchChanged();
         }
     });
@@ -862,6 +923,7 @@ void ResearchManager::initConnections()
             && m_currentResearch->type() == Research::Character) {
             auto* researchCharacter = dynamic_cast<ResearchCharacter*>(m_currentResearch);
             researchCharacter->setDescriptionText(_description);
+            markResearchChanged(m_currentResearch);
             emit researchChanged();
         }
     });
@@ -880,6 +942,7 @@ void ResearchManager::initConnections()
             if (StorageFacade::researchStorage()->hasLocation(_name)) {
                 Research* mainLocation = StorageFacade::researchStorage()->location(_name);
                 mainLocation->addDescription(m_currentResearch->description());
+                markResearchChanged(mainLocation);
                 removeResearchItem(m_currentResearchItem);
             }
             //
@@ -887,6 +950,7 @@ void ResearchManager::initConnections()
             //
             else {
                 m_currentResearch->setName(newName);
+                markResearchChanged(m_currentResearch);
                 m_model->updateItem(m_model->itemForIndex(m_view->currentResearchIndex()));
             }
             emit researchChanged();
@@ -898,6 +962,7 @@ void ResearchManager::initConnections()
             && m_currentResearch->type() == Research::Location
             && m_currentResearch->description() != _description) {
             m_currentResearch->setDescription(_description);
+            markResearchChanged(m_currentResearch);
             emit researchChanged();
         }
     });
@@ -910,6 +975,7 @@ void ResearchManager::initConnections()
                 || m_currentResearch->type() == Research::Text)
             && m_currentResearch->name() != _name) {
             m_currentResearch->setName(_name);
+            markResearchChanged(m_currentResearch);
             m_model->updateItem(m_model->itemForIndex(m_view->currentResearchIndex()));
             emit researchChanged();
         }
@@ -920,6 +986,7 @@ void ResearchManager::initConnections()
                 || m_currentResearch->type() == Research::Text)
             && m_currentResearch->description() != _description) {
             m_currentResearch->setDescription(_description);
+            markResearchChanged(m_currentResearch);
             emit researchChanged();
         }
     });
@@ -931,6 +998,7 @@ void ResearchManager::initConnections()
             && m_currentResearch->type() == Research::Url
             && m_currentResearch->name() != _name) {
             m_currentResearch->setName(_name);
+            markResearchChanged(m_currentResearch);
             m_model->updateItem(m_model->itemForIndex(m_view->currentResearchIndex()));
             emit researchChanged();
         }
@@ -940,6 +1008,7 @@ void ResearchManager::initConnections()
             && m_currentResearch->type() == Research::Url
             && m_currentResearch->url() != _urlLink) {
             m_currentResearch->setUrl(_urlLink);
+            markResearchChanged(m_currentResearch);
             m_model->updateItem(m_model->itemForIndex(m_view->currentResearchIndex()));
             emit researchChanged();
         }
@@ -949,6 +1018,7 @@ void ResearchManager::initConnections()
             && m_currentResearch->type() == Research::Url
             && m_currentResearch->description() != _html) {
             m_currentResearch->setDescription(_html);
+            markResearchChanged(m_currentResearch);
             emit researchChanged();
         }
     });
@@ -960,6 +1030,7 @@ void ResearchManager::initConnections()
             && m_currentResearch->type() == Research::ImagesGallery
             && m_currentResearch->name() != _name) {
             m_currentResearch->setName(_name);
+            markResearchChanged(m_currentResearch);
             m_model->updateItem(m_model->itemForIndex(m_view->currentResearchIndex()));
             emit researchChanged();
         }
@@ -974,6 +1045,7 @@ void ResearchManager::initConnections()
                 StorageFacade::researchStorage()->storeResearch(
                     m_currentResearch, Research::Image, _sortOrder, tr("Unnamed image"));
             newResearch->setImage(_image);
+            markResearchChanged(newResearch);
 
             emit researchChanged();
         }
@@ -997,6 +1069,7 @@ void ResearchManager::initConnections()
             for (int childIndex = _sortOrder; childIndex < m_currentResearchItem->childCount(); ++childIndex) {
                 Research* research = m_currentResearchItem->childAt(childIndex)->research();
                 research->setSortOrder(research->sortOrder() - 1);
+                markResearchChanged(research);
             }
         }
     });
@@ -1008,6 +1081,7 @@ void ResearchManager::initConnections()
             && m_currentResearch->type() == Research::Image
             && m_currentResearch->name() != _name) {
             m_currentResearch->setName(_name);
+            markResearchChanged(m_currentResearch);
             m_model->updateItem(m_model->itemForIndex(m_view->currentResearchIndex()));
             emit researchChanged();
         }
@@ -1016,6 +1090,7 @@ void ResearchManager::initConnections()
         if (m_currentResearch != nullptr
             && m_currentResearch->type() == Research::Image) {
             m_currentResearch->setImage(_image);
+            markResearchChanged(m_currentResearch);
             emit researchChanged();
         }
     });
@@ -1027,6 +1102,7 @@ void ResearchManager::initConnections()
             && m_currentResearch->type() == Research::MindMap
             && m_currentResearch->name() != _name) {
             m_currentResearch->setName(_name);
+            markResearchChanged(m_currentResearch);
             m_model->updateItem(m_model->itemForIndex(m_view->currentResearchIndex()));
             emit researchChanged();
         }
@@ -1035,6 +1111,7 @@ void ResearchManager::initConnections()
         if (m_currentResearch != nullptr
             && m_currentResearch->type() == Research::MindMap) {
             m_currentResearch->setDescription(_xml);
+            markResearchChanged(m_currentResearch);
             emit researchChanged();
         }
     });
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QMap>
+#include <QSet>
 
 class QAbstractItemModel;
 
@@ -76,9 +77,15 @@ namespace ManagementLayer
 
         /**
          * @brief Сохранить разработки проекта
+         * @note Сохраняются только элементы и данные сценария, изменённые с момента прошлого сохранения
          */
         void saveResearch();
 
+        /**
+         * @brief Отметить все разработки несохранёнными, чтобы повторное сохранение записало их целиком
+         */
+        void markAllResearchUnsaved();
+
         /**
          * @brief Установить режим работы со сценарием
          */
@@ -219,6 +226,11 @@ namespace ManagementLayer
          */
         void updateScenarioData(const QString& _key, const QString& _value);
 
+        /**
+         * @brief Отметить элемент разработки изменённым, чтобы сохранить его при следующем сохранении проекта
+         */
+        void markResearchChanged(Domain::Research* _research);
+
     private:
         /**
          * @brief Настроить представление
@@ -246,6 +258,23 @@ namespace ManagementLayer
          */
         QMap<QString, QString> m_scenarioData;
 
+        /**
+         * @brief Ключи данных сценария, изменённые с момента последнего сохранения
+         */
+        QSet<QString> m_changedScenarioDataKeys;
+
+        /**
+         * @brief Элементы разработки, изменённые с момента последнего сохранения
+         * @note Указатели только сравниваются с элементами хранилища и не разыменовываются,
+         *       поэтому удалённые после изменения элементы просто пропускаются
+         */
+        QSet<Domain::Research*> m_changedResearch;
+
+        /**
+         * @brief Нужно ли сохранить все элементы разработки
+         */
+        bool m_isAllResearchChanged = false;
+
         /**
          * @brief Модель данных о разработке
          */
@@ -9,6 +9,8 @@
 #include <DataLayer/DataStorageLayer/ScenarioStorage.h>
 #include <DataLayer/DataStorageLayer/SettingsStorage.h>
 
+#include <ManagementLayer/Tracing/Tracer.h>
+
 #include <UserInterfaceLayer/Scenario/ScenarioCards/PrintCardsDialog.h>
 #include <UserInterfaceLayer/Scenario/ScenarioCards/ScenarioCardsView.h>
 #include <UserInterfaceLayer/Scenario/ScenarioItemDialog/ScenarioItemDialog.h>
@@ -18,6 +20,7 @@
 #include <3rd_party/Helpers/TextUtils.h>
 
 #include <QApplication>
+#include <QEvent>
 #include <QPainter>
 #include <QPrinter>
 #include <QPrintPreviewDialog>
@@ -41,6 +44,8 @@ ScenarioCardsManager::ScenarioCardsManager(QObject* _parent, QWidget* _parentWid
 {
     initConnections();
     reloadSettings();
+
+    m_view->installEventFilter(this);
 }
 
 QWidget* ScenarioCardsManager::view() const
@@ -74,21 +79,62 @@ void ScenarioCardsManager::reloadSettings()
 
 QString ScenarioCardsManager::save() const
 {
+    if (isLoadPending()) {
+        return m_pendingXml;
+    }
+
     return m_view->save();
 }
 
 void ScenarioCardsManager::saveChanges(bool _hasChangesInText)
 {
+    if (isLoadPending()) {
+        return;
+    }
+
     m_view->saveChanges(_hasChangesInText);
 }
 
 void ScenarioCardsManager::load(BusinessLogic::ScenarioModel* _model, const QString& _xml)
 {
+    m_pendingModel = _model;
+    m_pendingXml = _xml;
+
+    if (m_view->isVisible()) {
+        loadPending();
+    }
+}
+
+bool ScenarioCardsManager::isLoadPending() const
+{
+    return m_pendingModel != nullptr;
+}
+
+bool ScenarioCardsManager::eventFilter(QObject* _watched, QEvent* _event)
+{
+    if (_watched == m_view
+        && _event->type() == QEvent::Show
+        && isLoadPending()) {
+        loadPending();
+    }
+
+    return QObject::eventFilter(_watched, _event);
+}
+
+void ScenarioCardsManager::loadPending()
+{
+    const Tracer::Span span("ScenarioCardsManager::loadPending");
+
+    BusinessLogic::ScenarioModel* model = m_pendingModel;
+    const QString xml = m_pendingXml;
+    m_pendingModel = nullptr;
+    m_pendingXml.clear();
+
     //
     // Сохраним модель
     //
-    if (m_model != _model) {
-        m_model = _model;
+    if (m_model != model) {
+        m_model = model;
         connect(m_model, &BusinessLogic::ScenarioModel::rowsInserted, this, [this] (const QModelIndex& _parent, int _first, int _last) {
             //
             // Пробегаем каждый добавленный элемент
@@ -156,24 +202,11 @@ void ScenarioCardsManager::load(BusinessLogic::ScenarioModel* _model, const QStr
         connect(m_model, &BusinessLogic::ScenarioModel::dataChanged, this, [this] (const QModelIndex& _topLeft, const QModelIndex& _bottomRight) {
             for (int row = _topLeft.row(); row <= _bottomRight.row(); ++row) {
                 const QModelIndex index = m_model->index(row, 0, _topLeft.parent());
-                const BusinessLogic::ScenarioModelItem* item = m_model->itemForIndex(index);
-                const bool isAct =
-                        item->type() == BusinessLogic::ScenarioModelItem::Folder
-                        && item->hasParent()
-                        && item->parent()->type() == BusinessLogic::ScenarioModelItem::Scenario;
-                const bool isEmbedded =
-                        item->hasParent()
-                        && item->parent()->type() != BusinessLogic::ScenarioModelItem::Scenario;
-                m_view->updateCard(
-                    item->uuid(),
-                    item->type() == BusinessLogic::ScenarioModelItem::Folder,
-                    item->sceneNumber(),
-                    item->name().isEmpty() ? TextEditHelper::smartToUpper(item->header()) : TextEditHelper::smartToUpper(item->name()),
-                    item->description().isEmpty() ? item->fullText() : item->description(),
-                    item->stamp(),
-                    item->colors(),
-                    isEmbedded,
-                    isAct);
+                if (m_updatesLevel > 0) {
+                    m_changedIndexes.insert(index);
+                } else {
+                    updateCard(index);
+                }
             }
         });
     }
@@ -183,8 +216,8 @@ void ScenarioCardsManager::load(BusinessLogic::ScenarioModel* _model, const QStr
     //
     // ... если схема есть, то просто загружаем её
     //
-    if (!_xml.isEmpty()) {
-        m_view->load(_xml);
+    if (!xml.isEmpty()) {
+        m_view->load(xml);
     }
     //
     // ... а если схема пуста, сформируем её на основе модели
@@ -196,20 +229,58 @@ void ScenarioCardsManager::load(BusinessLogic::ScenarioModel* _model, const QStr
 
 void ScenarioCardsManager::clear()
 {
+    m_pendingModel = nullptr;
+    m_pendingXml.clear();
     if (m_model != nullptr) {
         m_model->disconnect(this);
         m_model = nullptr;
     }
+    m_changedIndexes.clear();
     m_view->clear();
 }
 
+void ScenarioCardsManager::beginUpdates()
+{
+    ++m_updatesLevel;
+}
+
+void ScenarioCardsManager::endUpdates()
+{
+    Q_ASSERT(m_updatesLevel > 0);
+    if (--m_updatesLevel > 0) {
+        return;
+    }
+
+    //
+    // Обновляем каждую изменившуюся карточку один раз, удалённые за время пакета элементы пропускаем
+    //
+    const QSet<QPersistentModelIndex> changedIndexes = m_changedIndexes;
+    m_changedIndexes.clear();
+    if (m_model == nullptr) {
+        return;
+    }
+    for (const QPersistentModelIndex& index : changedIndexes) {
+        if (index.isValid()) {
+            updateCard(index);
+        }
+    }
+}
+
 void ScenarioCardsManager::undo()
 {
+    if (isLoadPending()) {
+        return;
+    }
+
     m_view->undo();
 }
 
 void ScenarioCardsManager::redo()
 {
+    if (isLoadPending()) {
+        return;
+    }
+
     m_view->redo();
 }
 
@@ -693,6 +764,28 @@ void ScenarioCardsManager::printCards(QPrinter* _printer)
     m_printDialog->setEnabled(true);
 }
 
+void ScenarioCardsManager::updateCard(const QModelIndex& _index)
+{
+    const BusinessLogic::ScenarioModelItem* item = m_model->itemForIndex(_index);
+    const bool isAct =
+            item->type() == BusinessLogic::ScenarioModelItem::Folder
+            && item->hasParent()
+            && item->parent()->type() == BusinessLogic::ScenarioModelItem::Scenario;
+    const bool isEmbedded =
+            item->hasParent()
+            && item->parent()->type() != BusinessLogic::ScenarioModelItem::Scenario;
+    m_view->updateCard(
+        item->uuid(),
+        item->type() == BusinessLogic::ScenarioModelItem::Folder,
+        item->sceneNumber(),
+        item->name().isEmpty() ? TextEditHelper::smartToUpper(item->header()) : TextEditHelper::smartToUpper(item->name()),
+        item->description().isEmpty() ? item->fullText() : item->description(),
+        item->stamp(),
+        item->colors(),
+        isEmbedded,
+        isAct);
+}
+
 void ScenarioCardsManager::initConnections()
 {
     //
@@ -3,6 +3,8 @@
 
 #include <QModelIndexList>
 #include <QObject>
+#include <QPersistentModelIndex>
+#include <QSet>
 
 class QPrinter;
 
@@ -51,9 +53,16 @@ namespace ManagementLayer
 
         /**
          * @brief Загрузить заданную схему
+         * @note Карточки строятся при первом показе представления, т.к. большинство сессий
+         *       работы с проектом обходятся без них
          */
         void load(BusinessLogic::ScenarioModel* _model, const QString& _xml);
 
+        /**
+         * @brief Ожидают ли карточки построения
+         */
+        bool isLoadPending() const;
+
         /**
          * @brief Очистить данные схемы и модель
          */
@@ -74,6 +83,17 @@ namespace ManagementLayer
          */
         void setCommentOnly(bool _isCommentOnly);
 
+        /**
+         * @brief Начать пакетное изменение модели
+         * @note До завершения пакета обновления карточек копятся и выполняются один раз в endUpdates
+         */
+        void beginUpdates();
+
+        /**
+         * @brief Завершить пакетное изменение модели и обновить изменившиеся карточки
+         */
+        void endUpdates();
+
     signals:
         /**
          * @brief Запрос на отмену последнего действия
@@ -182,7 +202,23 @@ namespace ManagementLayer
         void printCards(QPrinter* _printer);
         /** @} */
 
+    protected:
+        /**
+         * @brief Переопределяется, чтобы построить карточки при первом показе представления
+         */
+        bool eventFilter(QObject* _watched, QEvent* _event) override;
+
     private:
+        /**
+         * @brief Построить карточки по отложенной схеме
+         */
+        void loadPending();
+
+        /**
+         * @brief Обновить карточку элемента модели
+         */
+        void updateCard(const QModelIndex& _index);
+
         /**
          * @brief Настроить соединения
          */
@@ -208,6 +244,24 @@ namespace ManagementLayer
          * @brief Модель сценария
          */
         BusinessLogic::ScenarioModel* m_model = nullptr;
+
+        /**
+         * @brief Модель и схема, по которым нужно построить карточки при первом показе
+         */
+        /** @{ */
+        BusinessLogic::ScenarioModel* m_pendingModel = nullptr;
+        QString m_pendingXml;
+        /** @} */
+
+        /**
+         * @brief Уровень вложенности пакетного изменения модели
+         */
+        int m_updatesLevel = 0;
+
+        /**
+         * @brief Элементы, карточки которых нужно обновить по завершении пакетного изменения
+         */
+        QSet<QPersistentModelIndex> m_changedIndexes;
     };
 }
 
@@ -4,8 +4,16 @@
 #include "ScenarioNavigatorManager.h"
 #include "ScenarioSceneDescriptionManager.h"
 #include "ScenarioTextEditManager.h"
+#include "ScriptBlocksColorsUpdater.h"
 #include "ScriptBookmarksManager.h"
+#include "ScriptChronometryIndex.h"
 #include "ScriptDictionariesManager.h"
+#include "ScriptIndexesLoader.h"
+#include "ScriptItemsIndex.h"
+#include "ScriptNamesIndex.h"
+#include "ScriptPatchRebaser.h"
+#include "ScriptProgressiveLoader.h"
+#include "ScriptTextCountersIndex.h"
 
 #include <Domain/Research.h>
 #include <Domain/Scenario.h>
@@ -18,7 +26,6 @@
 #include <BusinessLayer/ScenarioDocument/ScenarioTextBlockParsers.h>
 #include <BusinessLayer/ScenarioDocument/ScenarioTextDocument.h>
 #include <BusinessLayer/ScenarioDocument/ScenarioModel.h>
-#include <BusinessLayer/ScenarioDocument/ScriptTextCursor.h>
 
 #include <DataLayer/Database/Database.h>
 
@@ -30,6 +37,9 @@
 #include <DataLayer/DataStorageLayer/ResearchStorage.h>
 #include <DataLayer/DataStorageLayer/SettingsStorage.h>
 
+#include <ManagementLayer/Project/ProjectsManager.h>
+#include <ManagementLayer/Tracing/Tracer.h>
+
 #include <3rd_party/Helpers/DiffMatchPatchHelper.h>
 #include <3rd_party/Helpers/RunOnce.h>
 #include <3rd_party/Helpers/ShortcutHelper.h>
@@ -42,10 +52,12 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QShortcut>
+#include <QSignalBlocker>
 #include <QSet>
 #include <QSplitter>
 #include <QStackedWidget>
 #include <QTextCursor>
+#include <QTextDocument>
 #include <QTextBlock>
 #include <QTextTable>
 #include <QTimer>
@@ -56,11 +68,17 @@ using ManagementLayer::ScenarioCardsManager;
 using ManagementLayer::ScenarioNavigatorManager;
 using ManagementLayer::ScenarioSceneDescriptionManager;
 using ManagementLayer::ScenarioTextEditManager;
+using ManagementLayer::ScriptBlocksColorsUpdater;
 using ManagementLayer::ScriptBookmarksManager;
+using ManagementLayer::ScriptChronometryIndex;
 using ManagementLayer::ScriptDictionariesManager;
+using ManagementLayer::ScriptIndexesLoader;
+using ManagementLayer::ScriptItemsIndex;
+using ManagementLayer::ScriptNamesIndex;
+using ManagementLayer::ScriptPatchRebaser;
+using ManagementLayer::ScriptProgressiveLoader;
+using ManagementLayer::ScriptTextCountersIndex;
 using BusinessLogic::ScenarioDocument;
-using BusinessLogic::ScenarioBlockStyle;
-using BusinessLogic::ScriptTextCursor;
 
 namespace {
     /**
@@ -77,6 +95,19 @@ namespace {
     const int FAST_SAVE_CHANGES_INTERVAL = 1000;
     /** @} */
 
+    /**
+     * @brief Ограничения запоминаемых патчей собственных изменений: количество и суммарный размер, символов
+     */
+    /** @{ */
+    const int MAXIMUM_LOCAL_PATCHES_COUNT = 200;
+    const int MAXIMUM_LOCAL_PATCHES_SIZE = 2 * 1024 * 1024;
+    /** @} */
+
+    /**
+     * @brief Задержка обновления счётчиков после изменения текста, мс
+     */
+    const int UPDATE_COUNTERS_DELAY = 500;
+
     /**
      * @brief Индексы дополнительных панелей в навигаторе
      */
@@ -92,154 +123,15 @@ namespace {
      */
     static void updateScenarioForNewCharacterName(ScenarioDocument* _scenario,
         const QString _oldName, const QString& _newName) {
-
-        QTextCursor cursor(_scenario->document());
-        while (!cursor.isNull() && !cursor.atEnd()) {
-            cursor = _scenario->document()->find(_oldName, cursor);
-
-            if (!cursor.isNull()) {
-                //
-                // Выделенным должно быть именно имя, а не составная часть другого имени
-                //
-                bool replaceSelection = false;
-
-                //
-                // Если мы в блоке персонажа
-                //
-                if (ScenarioBlockStyle::forBlock(cursor.block()) == ScenarioBlockStyle::Character) {
-                    const QString name = BusinessLogic::CharacterParser::name(cursor.block().text());
-                    if (name == TextEditHelper::smartToUpper(cursor.selectedText())) {
-                        replaceSelection = true;
-                    }
-                }
-                //
-                // Если в блоке участники сцены
-                //
-                else if (ScenarioBlockStyle::forBlock(cursor.block()) == ScenarioBlockStyle::SceneCharacters) {
-                    const QStringList names = BusinessLogic::SceneCharactersParser::characters(cursor.block().text());
-                    if (names.contains(TextEditHelper::smartToUpper(cursor.selectedText()))) {
-                        //
-                        // Убедимся, что выделено именно имя, а не часть другого имени
-                        //
-                        QTextCursor checkCursor(cursor);
-                        // ... всё ли в порядке слева
-                        bool atLeftAllOk = false;
-                        checkCursor.setPosition(cursor.selectionStart());
-                        if (checkCursor.atBlockStart()) {
-                            atLeftAllOk = true;
-                        } else {
-                            checkCursor.movePosition(QTextCursor::PreviousCharacter, QTextCursor::KeepAnchor);
-                            if (checkCursor.selectedText() == " "
-                                || checkCursor.selectedText() == ",") {
-                                atLeftAllOk = true;
-                            } else {
-                                atLeftAllOk = false;
-                            }
-                        }
-                        // ... всё ли в порядке справа
-                        bool atRightAllOk = false;
-                        checkCursor.setPosition(cursor.selectionEnd());
-                        if (checkCursor.atBlockEnd()) {
-                            atRightAllOk = true;
-                        } else {
-                            checkCursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-                            if (checkCursor.selectedText() == " "
-                                || checkCursor.selectedText() == ",") {
-                                atRightAllOk = true;
-                            } else {
-                                atRightAllOk = false;
-                            }
-                        }
-                        // ... если со всех сторон всё в порядке - заменяем
-                        if (atLeftAllOk && atRightAllOk) {
-                            replaceSelection = true;
-                        }
-                    }
-                }
-
-                //
-                // Если выделено имя для замены, меняем его
-                //
-                if (replaceSelection) {
-                    cursor.insertText(_newName);
-                }
-            }
-        }
-    }
-
-    static void updateScenarioForNewLocationName(ScenarioDocument* _scenario,
-        const QString& _oldName, const QString& _newName) {
-
-        QTextCursor cursor(_scenario->document());
-        while (!cursor.isNull() && !cursor.atEnd()) {
-            cursor = _scenario->document()->find(_oldName, cursor);
-
-            if (!cursor.isNull()) {
-                //
-                // Выделенным должно быть именно локация, а не составная часть другой локации
-                //
-                bool replaceSelection = false;
-
-                //
-                // Если мы в блоке времени и места
-                //
-                if (ScenarioBlockStyle::forBlock(cursor.block()) == ScenarioBlockStyle::SceneHeading) {
-                    const QString location = BusinessLogic::SceneHeadingParser::locationName(cursor.block().text());
-                    if (location == TextEditHelper::smartToUpper(cursor.selectedText())) {
-                        replaceSelection = true;
-                    }
-                }
-
-                //
-                // Если выделено имя для замены, меняем его
-                //
-                if (replaceSelection) {
-                    cursor.insertText(_newName);
-                }
-            }
-        }
+        ScriptNamesIndex::forDocument(_scenario->document())->renameCharacter(_oldName, _newName);
     }
 
     /**
-     * @brief Обновить цвета текста и фона блоков для заданного документа
+     * @brief Обновить текст сценария для нового названия локации
      */
-    static void updateDocumentBlocksColors(QTextDocument* _document) {
-        ScriptTextCursor cursor(_document);
-        cursor.beginEditBlock();
-        do {
-            cursor.movePosition(QTextCursor::StartOfBlock);
-            ScenarioBlockStyle blockStyle
-                    = BusinessLogic::ScenarioTemplateFacade::getTemplate().blockStyle(cursor.block());
-            //
-            // Если в блоке есть выделения, обновляем цвет только тех частей, которые не входят в выделения
-            //
-            QTextBlock currentBlock = cursor.block();
-            if (!currentBlock.textFormats().isEmpty()) {
-                for (const QTextLayout::FormatRange& range : currentBlock.textFormats()) {
-                    if (!range.format.boolProperty(ScenarioBlockStyle::PropertyIsReviewMark)) {
-                        auto charFormat = blockStyle.charFormat();
-                        if (range.format.font().bold()) {
-                            charFormat.setFontWeight(QFont::Bold);
-                        }
-                        if (range.format.font().italic()) {
-                            charFormat.setFontItalic(true);
-                        }
-                        if (range.format.font().underline()) {
-                            charFormat.setFontUnderline(true);
-                        }
-                        cursor.setPosition(currentBlock.position() + range.start);
-                        cursor.setPosition(cursor.position() + range.length, QTextCursor::KeepAnchor);
-                        cursor.mergeCharFormat(charFormat);
-                    }
-                }
-            }
-            cursor.movePosition(QTextCursor::EndOfBlock);
-            cursor.mergeBlockCharFormat(blockStyle.charFormat());
-            cursor.mergeBlockFormat(blockStyle.blockFormat());
-
-            cursor.movePosition(QTextCursor::NextBlock);
-        } while (!cursor.atEnd());
-        cursor.endEditBlock();
+    static void updateScenarioForNewLocationName(ScenarioDocument* _scenario,
+        const QString& _oldName, const QString& _newName) {
+        ScriptNamesIndex::forDocument(_scenario->document())->renameLocation(_oldName, _newName);
     }
 }
 
@@ -251,6 +143,7 @@ ScenarioManager::ScenarioManager(QObject *_parent, QWidget* _parentWidget) :
     m_navigatorSplitter(new QSplitter(m_view)),
     m_scenario(new ScenarioDocument(this)),
     m_scenarioDraft(new ScenarioDocument(this)),
+    m_scenarioLoader(new ScriptProgressiveLoader(this)),
     m_cardsManager(new ScenarioCardsManager(this, _parentWidget)),
     m_navigatorManager(new ScenarioNavigatorManager(this, m_view)),
     m_draftNavigatorManager(new ScenarioNavigatorManager(this, m_view, IS_DRAFT)),
@@ -281,6 +174,16 @@ BusinessLogic::ScenarioDocument* ScenarioManager::scenario() const
     return m_scenario;
 }
 
+void ScenarioManager::finishScenarioLoading()
+{
+    m_scenarioLoader->finish();
+}
+
+bool ScenarioManager::isScenarioLoading() const
+{
+    return m_scenarioLoader->isRunning();
+}
+
 BusinessLogic::ScenarioDocument* ScenarioManager::scenarioDraft() const
 {
     return m_scenarioDraft;
@@ -317,47 +220,74 @@ void ScenarioManager::setCursorPosition(int _position) const
 
 void ScenarioManager::loadCurrentProject()
 {
+    const Tracer::Span span("ScenarioManager::loadCurrentProject");
+
     //
     // Загрузим сценарий
     //
     // ... чистовик
     //
+    // ... большой сценарий локального проекта загружаем по частям, начиная с места, где пользователь
+    //     закончил работу, а проекты из облака целиком, т.к. сразу после загрузки они синхронизируются
+    //
     Domain::Scenario* currentScenario =
             DataStorageLayer::StorageFacade::scenarioStorage()->current();
-    m_scenario->load(currentScenario);
+    const auto& project = ManagementLayer::ProjectsManager::currentProject();
+    if (project.isRemote()) {
+        m_scenario->load(currentScenario);
+    } else {
+        const int lastCursorPosition =
+                DataStorageLayer::StorageFacade::settingsStorage()->value(
+                    QString("projects/%1/last-cursor-position").arg(project.path()),
+                    DataStorageLayer::SettingsStorage::ApplicationSettings
+                    ).toInt();
+        m_scenarioLoader->load(m_scenario, currentScenario, lastCursorPosition);
+    }
+    //
+    // ... и проиндексируем имена персонажей, локаций и счётчики текста, чтобы дальше индексы
+    //     обновлялись по мере правок. Индексы строятся в фоне, пока загружаются остальные данные проекта,
+    //     а если сценарий ещё догружается, то после его загрузки
     //
-    // ... черновик
+    if (!m_scenarioLoader->isRunning()) {
+        ScriptIndexesLoader::loadAsync(m_scenario->document());
+    }
+    //
+    // ... загруженный документ совпадает с сохранённым
     //
-    Domain::Scenario* currentScenarioDraft =
-            DataStorageLayer::StorageFacade::scenarioStorage()->current(IS_DRAFT);
-    m_scenarioDraft->load(currentScenarioDraft);
+    m_scenarioModified = false;
+    m_scenarioChangesPending = false;
+    clearLocalChanges();
 
     //
     // Установим данные для менеджеров
     //
     m_navigatorManager->setNavigationModel(m_scenario->model());
-    m_draftNavigatorManager->setNavigationModel(m_scenarioDraft->model());
     m_scriptBookmarksManager->setBookmarksModel(m_scenario->document()->bookmarksModel());
     m_scriptDictionariesManager->refresh();
-    m_textEditManager->setScenarioDocument(m_scenarioDraft->document(), IS_DRAFT);
     m_textEditManager->setScenarioDocument(m_scenario->document());
+    m_workModeIsDraft = false;
     //
     // ... содержимое карточек устанавливаем в последнюю очередь, чтобы корректно загрузить схему
     //
-    m_cardsManager->load(m_scenario->model(), currentScenario->scheme());
+    // FIXME: Синхронизации схемы карточек пока нет, а текст сценария может измениться при синхронизации,
+    //        поэтому карточки всегда формируем из сценария, передавая пустую схему. Сами карточки
+    //        строятся один раз, при первом показе
+    //
+    m_cardsManager->load(m_scenario->model(), QString());
 
     //
-    // Обновим счётчики, когда данные полностью загрузятся
+    // Черновик большинству пользователей не нужен, поэтому разбираем его только при первом обращении,
+    // либо сразу, если панель черновика открыта
     //
-    QTimer::singleShot(100, this, &ScenarioManager::aboutUpdateCounters);
-}
+    m_isDraftLoadPending = true;
+    if (!m_navigatorSplitter->widget(DRAFT_PANEL_INDEX)->isHidden()) {
+        loadDraft();
+    }
 
-void ScenarioManager::rebuildCardsFromScript()
-{
     //
-    // Передаём пустую строку вместо схемы, чтобы карточки построились из текста сценария
+    // Обновим счётчики, когда данные полностью загрузятся
     //
-    m_cardsManager->load(m_scenario->model(), QString());
+    QTimer::singleShot(100, this, &ScenarioManager::aboutUpdateCounters);
 }
 
 void ScenarioManager::startChangesHandling()
@@ -370,6 +300,8 @@ void ScenarioManager::startChangesHandling()
 
 void ScenarioManager::loadCurrentProjectSettings(const QString& _projectPath)
 {
+    const Tracer::Span span("ScenarioManager::loadCurrentProjectSettings");
+
     //
     // Загрузим режим чистовик/черновик
     //
@@ -383,38 +315,80 @@ void ScenarioManager::loadCurrentProjectSettings(const QString& _projectPath)
     //
     // Загрузим позицию курсора
     //
-    const int lastCursorPosition =
+    int lastCursorPosition =
             DataStorageLayer::StorageFacade::settingsStorage()->value(
                 QString("projects/%1/last-cursor-position").arg(_projectPath),
                 DataStorageLayer::SettingsStorage::ApplicationSettings
                 ).toInt();
+    //
+    // ... позиция сохраняется для всего сценария, а загружена может быть только его часть
+    //
+    if (!m_workModeIsDraft) {
+        lastCursorPosition = m_scenarioLoader->toLoadedPosition(lastCursorPosition);
+    }
+    //
+    // ... если курсор оказался за пределами загруженной части сценария, то догружаем его
+    //
+    if (!m_workModeIsDraft
+        && lastCursorPosition >= m_scenario->document()->characterCount()) {
+        m_scenarioLoader->finish();
+    }
     m_textEditManager->setCursorPosition(lastCursorPosition);
 }
 
 void ScenarioManager::saveCurrentProject()
 {
-    //
-    // Сохраняем сценарий
-    //
-    m_scenario->scenario()->setText(m_scenario->save());
-    m_scenario->scenario()->setScheme(m_cardsManager->save());
-    DataStorageLayer::StorageFacade::scenarioStorage()->storeScenario(m_scenario->scenario());
+    const Tracer::Span span("ScenarioManager::saveCurrentProject");
 
     //
-    // Сохраняем черновик
+    // Неполный документ сохранять нельзя, поэтому если он изменён, то сперва догружаем его
     //
-    m_scenarioDraft->scenario()->setText(m_scenarioDraft->save());
-    DataStorageLayer::StorageFacade::scenarioStorage()->storeScenario(m_scenarioDraft->scenario());
+    if (m_scenarioModified) {
+        m_scenarioLoader->finish();
+    }
 
     //
     // Сохраняем изменения
     //
+    // ... делаем это в первую очередь: для поиска изменений документ сериализуется, и после этого
+    //     его xml-представление совпадает с текущим текстом, поэтому ниже используем его как снимок
+    //     для сохранения, не сериализуя большой сценарий второй раз
+    //
     aboutSaveScenarioChanges();
+
+    //
+    // Сохраняем сценарий
+    //
+    // ... текст сохраняем, только если он изменился, а схема карточек небольшая,
+    //     поэтому её достаточно сравнить с сохранённой
+    //
+    Domain::Scenario* scenario = m_scenario->scenario();
+    const QString scheme = m_cardsManager->isLoadPending() ? scenario->scheme() : m_cardsManager->save();
+    if (m_scenarioModified || scenario->scheme() != scheme) {
+        if (m_scenarioModified) {
+            scenario->setText(m_scenario->document()->scenarioXml());
+        }
+        scenario->setScheme(scheme);
+        DataStorageLayer::StorageFacade::scenarioStorage()->storeScenario(scenario);
+        m_scenarioModified = false;
+    }
+
+    //
+    // Сохраняем черновик
+    //
+    if (m_scenarioDraftModified) {
+        m_scenarioDraft->scenario()->setText(m_scenarioDraft->document()->scenarioXml());
+        DataStorageLayer::StorageFacade::scenarioStorage()->storeScenario(m_scenarioDraft->scenario());
+        m_scenarioDraftModified = false;
+    }
+
     DataStorageLayer::StorageFacade::scenarioChangeStorage()->store();
 }
 
 void ScenarioManager::saveCurrentProjectSettings(const QString& _projectPath)
 {
+    const Tracer::Span span("ScenarioManager::saveCurrentProjectSettings");
+
     //
     // Сохраним текущий режим чистовик/черновик
     //
@@ -424,16 +398,19 @@ void ScenarioManager::saveCurrentProjectSettings(const QString& _projectPath)
                 DataStorageLayer::SettingsStorage::ApplicationSettings);
 
     //
-    // Сохраним позицию курсора
+    // Сохраним позицию курсора относительно всего сценария, даже если он ещё загружен не полностью
     //
+    const int cursorPosition = m_textEditManager->cursorPosition();
     DataStorageLayer::StorageFacade::settingsStorage()->setValue(
                 QString("projects/%1/last-cursor-position").arg(_projectPath),
-                QString::number(m_textEditManager->cursorPosition()),
+                QString::number(m_workModeIsDraft ? cursorPosition : m_scenarioLoader->toFullPosition(cursorPosition)),
                 DataStorageLayer::SettingsStorage::ApplicationSettings);
 }
 
 void ScenarioManager::closeCurrentProject()
 {
+    const Tracer::Span span("ScenarioManager::closeCurrentProject");
+
     //
     // Остановим таймер сохранения изменений документа
     //
@@ -442,6 +419,7 @@ void ScenarioManager::closeCurrentProject()
     //
     // Очистим от предыдущих данных
     //
+    m_scenarioLoader->cancel();
     m_cardsManager->clear();
     m_navigatorManager->setNavigationModel(nullptr);
     m_draftNavigatorManager->setNavigationModel(nullptr);
@@ -451,8 +429,18 @@ void ScenarioManager::closeCurrentProject()
     //
     // Очистим сценарий
     //
+    // ... индексы блоков удаляем до очистки, чтобы они не обрабатывали удаление текста, а для
+    //     следующего проекта строились заново
+    //
+    ScriptNamesIndex::invalidate(m_scenario->document());
+    ScriptNamesIndex::invalidate(m_scenarioDraft->document());
+    ScriptChronometryIndex::invalidate(m_scenario->document());
+    ScriptChronometryIndex::invalidate(m_scenarioDraft->document());
+    ScriptTextCountersIndex::invalidate(m_scenario->document());
+    ScriptTextCountersIndex::invalidate(m_scenarioDraft->document());
     m_scenario->clear();
     m_scenarioDraft->clear();
+    m_isDraftLoadPending = false;
 }
 
 void ScenarioManager::setCommentOnly(bool _isCommentOnly)
@@ -516,13 +504,27 @@ void ScenarioManager::aboutTextEditSettingsUpdated()
 
     m_textEditManager->reloadTextEditSettings();
 
-    updateDocumentBlocksColors(m_scenario->document());
-    updateDocumentBlocksColors(m_scenarioDraft->document());
+    //
+    // Сначала обновляем видимую часть документа, с которым работает пользователь,
+    // остальное обновится порциями, не блокируя интерфейс
+    //
+    ScenarioDocument* currentScenario = workingScenario();
+    ScenarioDocument* otherScenario = m_workModeIsDraft ? m_scenario : m_scenarioDraft;
+    const QPair<int, int> visibleRange = m_textEditManager->visibleTextRange();
+    ScriptBlocksColorsUpdater::forDocument(currentScenario->document())->update(visibleRange.first, visibleRange.second);
+    ScriptBlocksColorsUpdater::forDocument(otherScenario->document())->update();
 
     //
     // Корректируем текст, т.к. могли измениться настройки отображения, или используемого шаблона
     //
     m_scenario->document()->correct();
+
+    //
+    // ... от шаблона зависит и хронометраж блоков
+    //
+    ScriptChronometryIndex::invalidate(m_scenario->document());
+    ScriptChronometryIndex::invalidate(m_scenarioDraft->document());
+    aboutUpdateDuration(m_textEditManager->cursorPosition());
 }
 
 void ScenarioManager::aboutNavigatorSettingsUpdated()
@@ -533,6 +535,8 @@ void ScenarioManager::aboutNavigatorSettingsUpdated()
 
 void ScenarioManager::aboutChronometrySettingsUpdated()
 {
+    ScriptChronometryIndex::invalidate(m_scenario->document());
+    ScriptChronometryIndex::invalidate(m_scenarioDraft->document());
     aboutRefreshDuration(m_textEditManager->cursorPosition());
     m_textEditManager->reloadTextEditSettings();
 }
@@ -548,17 +552,21 @@ void ScenarioManager::aboutCharacterNameChanged(const QString& _oldName, const Q
     //
     // Обновить тексты всех сценариев
     //
+    m_scenarioLoader->finish();
     ::updateScenarioForNewCharacterName(m_scenario, _oldName, _newName);
+    loadDraft();
     ::updateScenarioForNewCharacterName(m_scenarioDraft, _oldName, _newName);
 }
 
 void ScenarioManager::aboutRefreshCharacters()
 {
     //
-    // Найти персонажей во всём тексте
+    // Берём персонажей из индексов документов, которые обновляются по мере правки текста
     //
-    QSet<QString> characters = QSet<QString>::fromList(m_scenario->findCharacters());
-    characters.unite(QSet<QString>::fromList(m_scenarioDraft->findCharacters()));
+    m_scenarioLoader->finish();
+    loadDraft();
+    QSet<QString> characters = ScriptNamesIndex::forDocument(m_scenario->document())->characters();
+    characters.unite(ScriptNamesIndex::forDocument(m_scenarioDraft->document())->characters());
 
     //
     // Определить персонажи, которых нет в тексте
@@ -615,17 +623,21 @@ void ScenarioManager::aboutLocationNameChanged(const QString& _oldName, const QS
     //
     // Обновить тексты всех сценариев
     //
+    m_scenarioLoader->finish();
     ::updateScenarioForNewLocationName(m_scenario, _oldName, _newName);
+    loadDraft();
     ::updateScenarioForNewLocationName(m_scenarioDraft, _oldName, _newName);
 }
 
 void ScenarioManager::aboutRefreshLocations()
 {
     //
-    // Найти локации во всём тексте
+    // Берём локации из индексов документов, которые обновляются по мере правки текста
     //
-    QSet<QString> locations = QSet<QString>::fromList(m_scenario->findLocations());
-    locations.unite(QSet<QString>::fromList(m_scenarioDraft->findLocations()));
+    m_scenarioLoader->finish();
+    loadDraft();
+    QSet<QString> locations = ScriptNamesIndex::forDocument(m_scenario->document())->locations();
+    locations.unite(ScriptNamesIndex::forDocument(m_scenarioDraft->document())->locations());
 
     //
     // Определить локации, которых нет в тексте
@@ -680,8 +692,31 @@ void ScenarioManager::aboutRefreshLocations()
 
 void ScenarioManager::aboutApplyPatch(const QString& _patch, bool _isDraft, int _newChangesSize)
 {
+    if (_isDraft) {
+        loadDraft();
+    } else {
+        m_scenarioLoader->finish();
+    }
     auto scriptTextDocument = _isDraft ? m_scenarioDraft->document() : m_scenario->document();
 
+    //
+    // Если пришедший патч удаётся перенести поверх собственных изменений, то просто применяем его
+    //
+    QStringList patches = { _patch };
+    QStringList localPatches;
+    if (rebaseOnLocalChanges(patches, localPatches, _isDraft, _newChangesSize)
+        && scriptTextDocument->canApplyPatch(patches.first())) {
+        scriptTextDocument->applyPatch(patches.first());
+        storeRebasedLocalChanges(_isDraft, localPatches);
+        return;
+    }
+
+    //
+    // Дальше собственные изменения могут быть откачены, или наложены заново, поэтому
+    // запомненные патчи больше не соответствуют документу
+    //
+    clearLocalChanges();
+
     //
     // Если пришедший патч накладывается без проблем, то просто применяем его
     //
@@ -739,8 +774,26 @@ void ScenarioManager::aboutApplyPatch(const QString& _patch, bool _isDraft, int
 
 void ScenarioManager::aboutApplyPatches(const QList<QString>& _patches, bool _isDraft, QList<QPair<QString, QString>>& _newChangesUuids)
 {
+    if (_isDraft) {
+        loadDraft();
+    } else {
+        m_scenarioLoader->finish();
+    }
     auto scriptTextDocument = _isDraft ? m_scenarioDraft->document() : m_scenario->document();
 
+    //
+    // Если пришедшие патчи удаётся перенести поверх собственных изменений, то просто применяем их
+    //
+    QStringList patches = _patches;
+    QStringList localPatches;
+    if (rebaseOnLocalChanges(patches, localPatches, _isDraft, _newChangesUuids.size())
+        && canApplyPatches(_isDraft, patches)) {
+        applyPatchesBatch(_isDraft, patches);
+        storeRebasedLocalChanges(_isDraft, localPatches);
+        return;
+    }
+    clearLocalChanges();
+
     //
     // Временно сохраним текущую версию текста сценария
     //
@@ -765,7 +818,7 @@ void ScenarioManager::aboutApplyPatches(const QList<QString>& _patches, bool _is
     //
     // Применяем патчи
     //
-    scriptTextDocument->applyPatches(_patches);
+    applyPatchesBatch(_isDraft, _patches);
 
     //
     // Пробуем накатить собственные изменения, если накатить не удалось, то удаляем их из списка для отправки
@@ -877,6 +930,8 @@ void ScenarioManager::setZenMode(bool _isZen)
 
 void ScenarioManager::setScriptXml(const QString& _xml)
 {
+    m_scenarioLoader->finish();
+
     BusinessLogic::ScenarioTextDocument* document = m_scenario->document();
     QTextCursor cursor(document);
     cursor.beginEditBlock();
@@ -893,7 +948,15 @@ void ScenarioManager::aboutUndo()
         return;
     }
 
+    prepareWorkingScenarioForEdit();
     aboutSaveScenarioChanges();
+
+    //
+    // Отмена и повтор меняют документ в обход сохранения изменений, поэтому патчи собственных
+    // изменений больше не описывают документ
+    //
+    clearLocalChanges();
+
     int toScroll = workingScenario()->document()->undoReimpl();
     if (toScroll != -1) {
         m_textEditManager->scrollToPosition(toScroll);
@@ -908,6 +971,9 @@ void ScenarioManager::aboutRedo()
         return;
     }
 
+    prepareWorkingScenarioForEdit();
+    clearLocalChanges();
+
     int toScroll = workingScenario()->document()->redoReimpl();
     if (toScroll != -1) {
         m_textEditManager->scrollToPosition(toScroll);
@@ -927,10 +993,22 @@ void ScenarioManager::aboutUpdateDuration(int _cursorPosition)
 {
     QString duration;
     if (BusinessLogic::ChronometerFacade::chronometryUsed()) {
-        QString durationToCursor =
-                BusinessLogic::ChronometerFacade::secondsToTime(workingScenario()->durationAtPosition(_cursorPosition));
-        QString durationToEnd =
-                BusinessLogic::ChronometerFacade::secondsToTime(workingScenario()->fullDuration());
+        //
+        // Берём хронометраж из индекса блоков, чтобы не пересчитывать его по всему сценарию
+        // при каждом нажатии клавиши и перемещении курсора, если текущая система это позволяет
+        //
+        qreal secondsToCursor = 0;
+        qreal secondsToEnd = 0;
+        if (ScriptChronometryIndex::isApplicable()) {
+            const ScriptChronometryIndex* chronometry = ScriptChronometryIndex::forDocument(workingScenario()->document());
+            secondsToCursor = chronometry->durationAtPosition(_cursorPosition);
+            secondsToEnd = chronometry->fullDuration();
+        } else {
+            secondsToCursor = workingScenario()->durationAtPosition(_cursorPosition);
+            secondsToEnd = workingScenario()->fullDuration();
+        }
+        QString durationToCursor = BusinessLogic::ChronometerFacade::secondsToTime(secondsToCursor);
+        QString durationToEnd = BusinessLogic::ChronometerFacade::secondsToTime(secondsToEnd);
         duration = QString("%1: <b>%2 | %3</b>").arg(tr("Chron.")).arg(durationToCursor).arg(durationToEnd);
     }
 
@@ -945,42 +1023,80 @@ void ScenarioManager::aboutRefreshCounters()
 
 void ScenarioManager::aboutUpdateCounters()
 {
-    m_textEditManager->setCountersInfo(workingScenario()->countersInfo());
+    //
+    // Слова и символы берём из индекса, который пересчитывает только изменённые блоки,
+    // а если нужно количество страниц, то все счётчики считаем заново по всему сценарию
+    //
+    if (!ScriptTextCountersIndex::isApplicable()) {
+        m_textEditManager->setCountersInfo(workingScenario()->countersInfo());
+        return;
+    }
+
+    const auto isCounterUsed = [] (const QString& _key) {
+        return
+                DataStorageLayer::StorageFacade::settingsStorage()->value(
+                    _key, DataStorageLayer::SettingsStorage::ApplicationSettings).toInt();
+    };
+
+    const ScriptTextCountersIndex::Counters counters =
+            ScriptTextCountersIndex::forDocument(workingScenario()->document())->total();
+    QStringList countersInfo;
+    if (isCounterUsed("counters/words/used")) {
+        countersInfo.append(QString("%1: <b>%2</b>").arg(tr("Words")).arg(counters.words));
+    }
+    if (isCounterUsed("counters/simbols/used")) {
+        countersInfo.append(
+                    QString("%1: <b>%2 | %3</b>")
+                    .arg(tr("Symbols"))
+                    .arg(counters.characters)
+                    .arg(counters.charactersWithoutSpaces));
+    }
+    m_textEditManager->setCountersInfo(countersInfo);
 }
 
 void ScenarioManager::aboutUpdateCurrentSceneTitleAndDescription(int _cursorPosition)
 {
-    QString itemTitle = workingScenario()->itemTitleAtPosition(_cursorPosition);
-    if (itemTitle.isEmpty()) {
-        //
-        // Если название сцены не задано, используем заголовок сцены
-        //
-        itemTitle = workingScenario()->itemHeaderAtPosition(_cursorPosition);
+    //
+    // Элемент в позиции курсора ищем по индексу, чтобы не обходить модель при каждом перемещении курсора
+    //
+    QString itemTitle;
+    QString description;
+    if (const BusinessLogic::ScenarioModelItem* item =
+            ScriptItemsIndex::forScenario(workingScenario())->itemAtPosition(_cursorPosition)) {
+        itemTitle = item->name();
+        if (itemTitle.isEmpty()) {
+            //
+            // Если название сцены не задано, используем заголовок сцены
+            //
+            itemTitle = item->header();
+        }
+        description = item->description();
     }
     m_sceneDescriptionManager->setTitle(itemTitle);
-
-    const QString description = workingScenario()->itemDescriptionAtPosition(_cursorPosition);
     m_sceneDescriptionManager->setDescription(description);
 }
 
 void ScenarioManager::aboutUpdateCurrentSceneTitle(const QString& _title)
 {
+    prepareWorkingScenarioForEdit();
     workingScenario()->setItemTitleAtPosition(m_textEditManager->cursorPosition(), _title);
 }
 
 void ScenarioManager::copySceneDescriptionToScript()
 {
+    prepareWorkingScenarioForEdit();
     workingScenario()->copyItemDescriptionToScript(m_textEditManager->cursorPosition());
 }
 
 void ScenarioManager::aboutUpdateCurrentSceneDescription(const QString& _description)
 {
+    prepareWorkingScenarioForEdit();
     workingScenario()->setItemDescriptionAtPosition(m_textEditManager->cursorPosition(), _description);
 }
 
 void ScenarioManager::aboutSelectItemInNavigator(int _cursorPosition)
 {
-    QModelIndex index = workingScenario()->itemIndexAtPosition(_cursorPosition);
+    QModelIndex index = ScriptItemsIndex::forScenario(workingScenario())->itemIndexAtPosition(_cursorPosition);
 
     if (!m_workModeIsDraft) {
         m_navigatorManager->setCurrentIndex(index);
@@ -993,7 +1109,7 @@ void ScenarioManager::aboutMoveCursorToItem(const QModelIndex& _index)
 {
     setWorkingMode(sender());
 
-    const int position = workingScenario()->itemStartPosition(_index);
+    const int position = ScriptItemsIndex::forScenario(workingScenario())->itemStartPosition(_index);
     m_textEditManager->setCursorPosition(position);
 }
 
@@ -1022,6 +1138,7 @@ void ScenarioManager::aboutAddItemFromCards(const QModelIndex& _afterItemIndex,
     // Карточки добавляются только в режиме чистовика
     //
     setWorkingMode(m_navigatorManager);
+    prepareWorkingScenarioForEdit();
 
     int position = 0;
     if (_itemType == BusinessLogic::ScenarioModelItem::Folder) {
@@ -1036,6 +1153,7 @@ void ScenarioManager::aboutAddItem(const QModelIndex& _afterItemIndex, int _item
     const QString& _name, const QString& _header, const QString& _description, const QColor& _color)
 {
     setWorkingMode(sender());
+    prepareWorkingScenarioForEdit();
 
     const int position = workingScenario()->itemEndPosition(_afterItemIndex);
     m_textEditManager->addScenarioItem(position, _itemType, _name, _header, _description, _color);
@@ -1048,6 +1166,7 @@ void ScenarioManager::aboutUpdateItemFromCards(const QModelIndex& _itemIndex, in
     // Изменение элемента из карточек только в режиме чистовика
     //
     setWorkingMode(m_navigatorManager);
+    prepareWorkingScenarioForEdit();
 
     const int startPosition = workingScenario()->itemStartPosition(_itemIndex);
     m_textEditManager->editScenarioItem(startPosition, _itemType, _name, _header, _colors);
@@ -1067,6 +1186,7 @@ void ScenarioManager::aboutRemoveItemFromCards(const QModelIndex& _index)
 void ScenarioManager::aboutRemoveItems(const QModelIndexList& _indexes)
 {
     setWorkingMode(sender());
+    prepareWorkingScenarioForEdit();
 
     const int from = workingScenario()->itemStartPosition(_indexes.first());
     const int to = workingScenario()->itemEndPosition(_indexes.last());
@@ -1076,6 +1196,7 @@ void ScenarioManager::aboutRemoveItems(const QModelIndexList& _indexes)
 void ScenarioManager::aboutSetItemsColors(const QModelIndexList& _indexes, const QString& _colors)
 {
     setWorkingMode(sender());
+    prepareWorkingScenarioForEdit();
 
     for (auto index : _indexes) {
         const int position = workingScenario()->itemStartPosition(index);
@@ -1089,6 +1210,7 @@ void ScenarioManager::aboutSetItemsColors(const QModelIndexList& _indexes, const
 void ScenarioManager::aboutSetItemStamp(const QModelIndex& _itemIndex, const QString& _stamp)
 {
     setWorkingMode(sender());
+    prepareWorkingScenarioForEdit();
 
     const int position = workingScenario()->itemStartPosition(_itemIndex);
     workingScenario()->setItemStampAtPosition(position, _stamp);
@@ -1100,6 +1222,7 @@ void ScenarioManager::aboutSetItemStamp(const QModelIndex& _itemIndex, const QSt
 void ScenarioManager::aboutChangeItemType(const QModelIndex& _index, int _type)
 {
     setWorkingMode(sender());
+    prepareWorkingScenarioForEdit();
 
     const int position = workingScenario()->itemStartPosition(_index);
     m_textEditManager->changeItemType(position, _type);
@@ -1109,6 +1232,9 @@ void ScenarioManager::aboutChangeItemType(const QModelIndex& _index, int _type)
 
 void ScenarioManager::setDraftVisible(bool _visible)
 {
+    if (_visible) {
+        loadDraft();
+    }
     setNavigatorPanelVisible(DRAFT_PANEL_INDEX, _visible);
 }
 
@@ -1143,16 +1269,35 @@ void ScenarioManager::aboutSaveScenarioChanges()
     //
     // Сохраняем изменения сценария
     //
-    Domain::ScenarioChange* change = m_scenario->document()->saveChanges();
-    if (change != nullptr) {
-        change->setIsDraft(false);
+    // ... сравнение с предыдущей версией документа дорогое и зависит от размера сценария,
+    //     поэтому выполняем его только если документ менялся с момента прошлого сравнения
+    //
+    // ... это экономит только проверки простаивающего документа: если текст менялся, то патчи
+    //     по-прежнему строятся сравнением XML всего документа, т.к. их формирует библиотека ядра
+    //
+    // ... пока сценарий догружается, сравнивать не с чем: исходное состояние документа фиксируется
+    //     по завершении загрузки
+    //
+    Domain::ScenarioChange* change = nullptr;
+    if (m_scenarioChangesPending
+        && !m_scenarioLoader->isRunning()) {
+        change = m_scenario->document()->saveChanges();
+        if (change != nullptr) {
+            change->setIsDraft(false);
+            addLocalChange(false, change->redoPatch());
+        }
+        m_scenarioChangesPending = false;
     }
     //
     // ... и черновика
     //
-    Domain::ScenarioChange* changeDraft = m_scenarioDraft->document()->saveChanges();
-    if (changeDraft != nullptr) {
-        changeDraft->setIsDraft(true);
+    if (m_scenarioDraftChangesPending) {
+        Domain::ScenarioChange* changeDraft = m_scenarioDraft->document()->saveChanges();
+        if (changeDraft != nullptr) {
+            changeDraft->setIsDraft(true);
+            addLocalChange(true, changeDraft->redoPatch());
+        }
+        m_scenarioDraftChangesPending = false;
     }
 
     //
@@ -1301,7 +1446,24 @@ void ScenarioManager::initConnections()
     connect(m_textEditManager, &ScenarioTextEditManager::textModeChanged, this, &ScenarioManager::aboutRefreshCounters);
     connect(m_textEditManager, &ScenarioTextEditManager::cursorPositionChanged, this, &ScenarioManager::aboutUpdateDuration);
     connect(m_textEditManager, &ScenarioTextEditManager::textChanged, [this] { aboutUpdateDuration(m_textEditManager->cursorPosition()); });
-    connect(m_textEditManager, &ScenarioTextEditManager::textChanged, this, &ScenarioManager::aboutUpdateCounters);
+    //
+    // Счётчики по индексу обновляем сразу, а если они пересчитываются по всему сценарию,
+    // то когда пользователь делает паузу в наборе, а не после каждого изменения текста
+    //
+    m_updateCountersTimer.setSingleShot(true);
+    m_updateCountersTimer.setInterval(UPDATE_COUNTERS_DELAY);
+    connect(m_textEditManager, &ScenarioTextEditManager::textChanged, this, [this] {
+        if (m_scenarioLoader->isInsertingPart()) {
+            return;
+        }
+
+        if (ScriptTextCountersIndex::isApplicable()) {
+            aboutUpdateCounters();
+        } else {
+            m_updateCountersTimer.start();
+        }
+    });
+    connect(&m_updateCountersTimer, &QTimer::timeout, this, &ScenarioManager::aboutUpdateCounters);
     connect(m_textEditManager, &ScenarioTextEditManager::cursorPositionChanged, this, &ScenarioManager::aboutUpdateCurrentSceneTitleAndDescription);
     connect(m_textEditManager, &ScenarioTextEditManager::cursorPositionChanged, this, &ScenarioManager::aboutSelectItemInNavigator, Qt::QueuedConnection);
     connect(m_textEditManager, &ScenarioTextEditManager::cursorPositionChanged, m_scriptBookmarksManager, static_cast<void (ScriptBookmarksManager::*)(int)>(&ScriptBookmarksManager::selectBookmark), Qt::QueuedConnection);
@@ -1332,7 +1494,64 @@ void ScenarioManager::initConnections()
     connect(m_cardsManager, &ScenarioCardsManager::cardsChanged, this, &ScenarioManager::scenarioChanged);
     connect(m_sceneDescriptionManager, &ScenarioSceneDescriptionManager::titleChanged, this, &ScenarioManager::scenarioChanged);
     connect(m_sceneDescriptionManager, &ScenarioSceneDescriptionManager::descriptionChanged, this, &ScenarioManager::scenarioChanged);
-    connect(m_textEditManager, &ScenarioTextEditManager::textChanged, this, &ScenarioManager::scenarioChanged);
+    //
+    // ... редактор сообщает и о добавлении догружаемых частей сценария, но это не его изменение
+    //
+    connect(m_textEditManager, &ScenarioTextEditManager::textChanged, this, [this] {
+        if (!m_scenarioLoader->isInsertingPart()) {
+            emit scenarioChanged();
+        }
+    });
+
+    //
+    // Помечаем документы изменёнными, чтобы при сохранении не сериализовать те, что не менялись.
+    // Цвета, штампы и описания сцен хранятся в данных блоков и могут не приводить к изменению текста,
+    // поэтому любое изменение сценария считаем изменением документа, с которым работает пользователь
+    //
+    connect(m_scenario, &ScenarioDocument::textChanged, this, [this] { m_scenarioModified = true; });
+    //
+    // Перед правкой текста пользователем догружаем сценарий, чтобы правка не смешалась с догружаемым текстом
+    //
+    connect(m_textEditManager, &ScenarioTextEditManager::textAboutToBeEdited, this, [this] {
+        prepareWorkingScenarioForEdit();
+    });
+    //
+    // ... пока сценарий догружается, удерживаем на экране место, где работает пользователь,
+    //     т.к. текст добавляется перед ним
+    //
+    connect(m_scenarioLoader, &ScriptProgressiveLoader::partInsertedBefore, this, [this] {
+        if (!m_workModeIsDraft) {
+            m_textEditManager->scrollToPosition(m_textEditManager->cursorPosition());
+        }
+    });
+    //
+    // ... загрузка завершается фиксацией документа как совпадающего с сохранённым
+    //
+    connect(m_scenarioLoader, &ScriptProgressiveLoader::finished, this, [this] {
+        m_scenarioChangesPending = false;
+        ScriptIndexesLoader::loadAsync(m_scenario->document());
+    });
+    connect(m_scenarioDraft, &ScenarioDocument::textChanged, this, [this] { m_scenarioDraftModified = true; });
+    connect(this, &ScenarioManager::scenarioChanged, this, [this] {
+        if (m_workModeIsDraft) {
+            m_scenarioDraftModified = true;
+        } else {
+            m_scenarioModified = true;
+        }
+    });
+    //
+    // Любая правка текста, либо данных блоков, например цветов и описаний сцен,
+    // требует сравнения документа с предыдущей версией при следующем сохранении изменений
+    //
+    connect(m_scenario->document(), &QTextDocument::contentsChange, this, [this] { m_scenarioChangesPending = true; });
+    connect(m_scenarioDraft->document(), &QTextDocument::contentsChange, this, [this] { m_scenarioDraftChangesPending = true; });
+    connect(this, &ScenarioManager::scenarioChanged, this, [this] {
+        if (m_workModeIsDraft) {
+            m_scenarioDraftChangesPending = true;
+        } else {
+            m_scenarioChangesPending = true;
+        }
+    });
 }
 
 void ScenarioManager::initStyleSheet()
@@ -1348,6 +1567,9 @@ void ScenarioManager::setWorkingMode(QObject* _sender)
         const bool workingModeIsDraft = manager == m_draftNavigatorManager;
 
         if (m_workModeIsDraft != workingModeIsDraft) {
+            if (workingModeIsDraft) {
+                loadDraft();
+            }
             m_workModeIsDraft = workingModeIsDraft;
 
             BusinessLogic::ScenarioTextDocument* prevTextDocument = 0;
@@ -1381,3 +1603,162 @@ BusinessLogic::ScenarioDocument* ScenarioManager::workingScenario() const
 {
     return m_workModeIsDraft ? m_scenarioDraft : m_scenario;
 }
+
+void ScenarioManager::prepareWorkingScenarioForEdit()
+{
+    //
+    // Правки в догружаемом документе смешались бы с загружаемым текстом и не попали бы в историю изменений
+    //
+    if (!m_workModeIsDraft) {
+        m_scenarioLoader->finish();
+    }
+}
+
+void ScenarioManager::loadDraft()
+{
+    if (!m_isDraftLoadPending) {
+        return;
+    }
+    m_isDraftLoadPending = false;
+
+    //
+    // Загрузка не является правкой пользователя, поэтому сигналы об изменении текста не испускаем
+    //
+    {
+        QSignalBlocker signalBlocker(m_scenarioDraft);
+        Domain::Scenario* currentScenarioDraft =
+                DataStorageLayer::StorageFacade::scenarioStorage()->current(IS_DRAFT);
+        m_scenarioDraft->load(currentScenarioDraft);
+    }
+    //
+    // ... проиндексируем имена персонажей, локаций и счётчики текста
+    //
+    ScriptIndexesLoader::loadAsync(m_scenarioDraft->document());
+    //
+    // ... загруженный документ совпадает с сохранённым
+    //
+    m_scenarioDraftModified = false;
+    m_scenarioDraftChangesPending = false;
+
+    m_draftNavigatorManager->setNavigationModel(m_scenarioDraft->model());
+}
+
+void ScenarioManager::applyPatchesBatch(bool _isDraft, const QStringList& _patches)
+{
+    //
+    // Объединяем применение патчей в одно действие, чтобы документ перестраивался, а модель сценария
+    // уведомляла о своих изменениях один раз после всех патчей, а не после каждого из них.
+    // Карточки строятся только по чистовику, их обновления копим до конца пакета
+    //
+    auto scriptTextDocument = _isDraft ? m_scenarioDraft->document() : m_scenario->document();
+    if (!_isDraft) {
+        m_cardsManager->beginUpdates();
+    }
+    QTextCursor cursor(scriptTextDocument);
+    cursor.beginEditBlock();
+    scriptTextDocument->applyPatches(_patches);
+    cursor.endEditBlock();
+    if (!_isDraft) {
+        m_cardsManager->endUpdates();
+    }
+}
+
+bool ScenarioManager::rebaseOnLocalChanges(QStringList& _patches, QStringList& _localPatches, bool _isDraft,
+                                           int _newChangesSize)
+{
+    if (_newChangesSize > m_localPatches.size()) {
+        return false;
+    }
+
+    //
+    // Несинхронизированные изменения - последние из сделанных, и все они должны относиться к этому документу
+    //
+    QStringList localPatches;
+    for (int index = m_localPatches.size() - _newChangesSize; index < m_localPatches.size(); ++index) {
+        if (m_localPatches.at(index).first != _isDraft) {
+            return false;
+        }
+        localPatches.append(m_localPatches.at(index).second);
+    }
+
+    if (!ScriptPatchRebaser::rebase(localPatches, _patches)) {
+        return false;
+    }
+
+    _localPatches = localPatches;
+    return true;
+}
+
+bool ScenarioManager::canApplyPatches(bool _isDraft, const QStringList& _patches)
+{
+    //
+    // Патчи применяются друг за другом, а проверить можно только применимость к текущему тексту,
+    // поэтому переводим их к текущему тексту и проверяем каждый
+    //
+    QStringList patches = _patches;
+    if (!ScriptPatchRebaser::toCommonBase(patches)) {
+        return false;
+    }
+
+    auto scriptTextDocument = _isDraft ? m_scenarioDraft->document() : m_scenario->document();
+    for (const QString& patch : patches) {
+        if (!scriptTextDocument->canApplyPatch(patch)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ScenarioManager::storeRebasedLocalChanges(bool _isDraft, const QStringList& _localPatches)
+{
+    //
+    // Запоминаем собственные изменения смещёнными, чтобы следующие патчи переносились уже поверх них
+    //
+    for (int index = 0; index < _localPatches.size(); ++index) {
+        QString& localPatch = m_localPatches[m_localPatches.size() - _localPatches.size() + index].second;
+        m_localPatchesSize -= localPatch.size();
+        localPatch = _localPatches.at(index);
+        m_localPatchesSize += localPatch.size();
+    }
+
+    //
+    // Изменения, ожидающие отправки, тоже заменяем смещёнными, чтобы у остальных участников они
+    // накладывались по точным позициям, а отмена работала с текстом, в котором уже есть пришедшие патчи.
+    // Все они последние в истории, т.к. отмена и повтор сбрасывают запомненные патчи
+    //
+    QList<ScenarioChange> changes;
+    DatabaseLayer::Database::transaction();
+    for (int index = 0; index < _localPatches.size(); ++index) {
+        changes.prepend(*DataStorageLayer::StorageFacade::scenarioChangeStorage()->last());
+        DataStorageLayer::StorageFacade::scenarioChangeStorage()->removeLast();
+    }
+    for (int index = 0; index < changes.size(); ++index) {
+        const QString& redoPatch = _localPatches.at(index);
+        DataStorageLayer::StorageFacade::scenarioChangeStorage()->append(
+                    changes[index].uuid().toString(), changes[index].datetime().toString("yyyy-MM-dd hh:mm:ss:zzz"),
+                    changes[index].user(), ScriptPatchRebaser::invert(redoPatch), redoPatch, _isDraft);
+    }
+    DatabaseLayer::Database::commit();
+
+    auto scriptTextDocument = _isDraft ? m_scenarioDraft->document() : m_scenario->document();
+    scriptTextDocument->updateUndoStack();
+}
+
+void ScenarioManager::addLocalChange(bool _isDraft, const QString& _redoPatch)
+{
+    //
+    // Строка патча разделяется с изменением в истории, поэтому запоминание не копирует его текст
+    //
+    m_localPatches.append({ _isDraft, _redoPatch });
+    m_localPatchesSize += _redoPatch.size();
+    while (m_localPatches.size() > MAXIMUM_LOCAL_PATCHES_COUNT
+           || m_localPatchesSize > MAXIMUM_LOCAL_PATCHES_SIZE) {
+        m_localPatchesSize -= m_localPatches.takeFirst().second.size();
+    }
+}
+
+void ScenarioManager::clearLocalChanges()
+{
+    m_localPatches.clear();
+    m_localPatchesSize = 0;
+}
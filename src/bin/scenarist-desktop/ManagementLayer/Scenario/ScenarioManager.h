@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QTimer>
 #include <QModelIndex>
+#include <QStringList>
 
 class FlatButton;
 class QComboBox;
@@ -25,6 +26,7 @@ namespace ManagementLayer
     class ScriptBookmarksManager;
     class ScriptDictionariesManager;
     class ScenarioTextEditManager;
+    class ScriptProgressiveLoader;
 
 
     /**
@@ -45,6 +47,17 @@ namespace ManagementLayer
          */
         BusinessLogic::ScenarioDocument* scenario() const;
 
+        /**
+         * @brief Догрузить сценарий, если он ещё загружается по частям
+         * @note Вызывается перед работой с документом сценария целиком, например перед экспортом
+         */
+        void finishScenarioLoading();
+
+        /**
+         * @brief Догружается ли ещё сценарий
+         */
+        bool isScenarioLoading() const;
+
         /**
          * @brief Получить черновик сценария
          */
@@ -70,11 +83,6 @@ namespace ManagementLayer
          */
         void loadCurrentProject();
 
-        /**
-         * @brief Сформировать карточки из сценария
-         */
-        void rebuildCardsFromScript();
-
         /**
          * @brief Запустить таймер сохранения изменений
          */
@@ -414,6 +422,52 @@ namespace ManagementLayer
          */
         BusinessLogic::ScenarioDocument* workingScenario() const;
 
+        /**
+         * @brief Подготовить документ текущего режима работы к правке
+         * @note Если правится чистовик, который ещё загружается по частям, то догружает его
+         */
+        void prepareWorkingScenarioForEdit();
+
+        /**
+         * @brief Загрузить черновик, если он ещё не был загружен
+         * @note Черновик загружается при первом обращении к нему, а не при открытии проекта
+         */
+        void loadDraft();
+
+        /**
+         * @brief Применить набор патчей к документу за одно действие
+         */
+        void applyPatchesBatch(bool _isDraft, const QStringList& _patches);
+
+        /**
+         * @brief Перенести пришедшие патчи поверх собственных несинхронизированных изменений
+         * @param _localPatches - собственные изменения, смещённые так, будто они сделаны после пришедших патчей
+         * @return false, если перенос невозможен и нужно откатывать собственные изменения
+         */
+        bool rebaseOnLocalChanges(QStringList& _patches, QStringList& _localPatches, bool _isDraft,
+                                  int _newChangesSize);
+
+        /**
+         * @brief Можно ли применить последовательность патчей к документу без откатывания изменений
+         */
+        bool canApplyPatches(bool _isDraft, const QStringList& _patches);
+
+        /**
+         * @brief Сохранить смещённые собственные изменения вместо исходных
+         * @note Заменяются и запомненные патчи, и ожидающие отправки изменения вместе с их отменой
+         */
+        void storeRebasedLocalChanges(bool _isDraft, const QStringList& _localPatches);
+
+        /**
+         * @brief Запомнить патч собственного изменения
+         */
+        void addLocalChange(bool _isDraft, const QString& _redoPatch);
+
+        /**
+         * @brief Забыть патчи собственных изменений, т.к. они больше не соответствуют документу
+         */
+        void clearLocalChanges();
+
     private:
         /**
          * @brief Представление сценария
@@ -453,6 +507,11 @@ namespace ManagementLayer
          */
         BusinessLogic::ScenarioDocument* m_scenarioDraft;
 
+        /**
+         * @brief Загрузчик сценария по частям
+         */
+        ScriptProgressiveLoader* m_scenarioLoader;
+
         /**
          * @brief Управляющий карточками
          */
@@ -501,6 +560,40 @@ namespace ManagementLayer
         bool m_fixedScenesDraft = false;
         /** @} */
 
+        /**
+         * @brief Изменялись ли чистовик и черновик с момента последнего сохранения
+         */
+        /** @{ */
+        bool m_scenarioModified = false;
+        bool m_scenarioDraftModified = false;
+        /** @} */
+
+        /**
+         * @brief Изменялись ли чистовик и черновик с момента последнего формирования изменения сценария
+         * @note Это не журнал правок: флаги позволяют лишь не сравнивать неизменившийся документ,
+         *       а стоимость формирования изменения после правки остаётся зависящей от размера сценария
+         */
+        /** @{ */
+        bool m_scenarioChangesPending = false;
+        bool m_scenarioDraftChangesPending = false;
+        /** @} */
+
+        /**
+         * @brief Патчи последних собственных изменений и признак того, что они сделаны в черновике
+         * @note Используются для переноса пришедших с сервера патчей без отката собственных изменений
+         */
+        QList<QPair<bool, QString>> m_localPatches;
+
+        /**
+         * @brief Суммарный размер запомненных патчей, символов
+         */
+        int m_localPatchesSize = 0;
+
+        /**
+         * @brief Нужно ли загрузить черновик открытого проекта при первом обращении к нему
+         */
+        bool m_isDraftLoadPending = false;
+
         /**
          * @brief Курсоры соавторов
          */
@@ -513,6 +606,11 @@ namespace ManagementLayer
          * @brief Таймер для сохранения изменений сценария
          */
         QTimer m_saveChangesTimer;
+
+        /**
+         * @brief Таймер для отложенного обновления счётчиков
+         */
+        QTimer m_updateCountersTimer;
     };
 }
 
@@ -192,6 +192,11 @@ void ScenarioTextEditManager::reloadTextEditSettings()
     m_view->updateToolBar();
 }
 
+QPair<int, int> ScenarioTextEditManager::visibleTextRange() const
+{
+    return m_view->visibleTextRange();
+}
+
 int ScenarioTextEditManager::cursorPosition() const
 {
     return m_view->cursorPosition();
@@ -312,4 +317,5 @@ void ScenarioTextEditManager::initConnections()
     connect(m_view, &ScenarioTextEditWidget::addBookmarkRequested, this, &ScenarioTextEditManager::addBookmarkRequested);
     connect(m_view, &ScenarioTextEditWidget::removeBookmarkRequested, this, &ScenarioTextEditManager::removeBookmarkRequested);
     connect(m_view, &ScenarioTextEditWidget::renameSceneNumberRequested, this, &ScenarioTextEditManager::renameSceneNumber);
+    connect(m_view, &ScenarioTextEditWidget::textAboutToBeEdited, this, &ScenarioTextEditManager::textAboutToBeEdited);
 }
@@ -2,6 +2,7 @@
 #define SCENARIOTEXTEDITMANAGER_H
 
 #include <QObject>
+#include <QPair>
 
 class QMenu;
 class QTextCursor;
@@ -55,6 +56,11 @@ namespace ManagementLayer
          */
         void reloadTextEditSettings();
 
+        /**
+         * @brief Получить диапазон позиций текста, видимого в редакторе
+         */
+        QPair<int, int> visibleTextRange() const;
+
         /**
          * @brief Получить текущую позицию курсора
          */
@@ -176,6 +182,11 @@ namespace ManagementLayer
          */
         void renameSceneNumberRequested(const QString& _newSceneNumber, int _position);
 
+        /**
+         * @brief Пользователь собирается изменить текст в редакторе
+         */
+        void textAboutToBeEdited();
+
     private slots:
         /**
          * @brief Реакция на изменение коэффициента масштабирования редактора сценария
@@ -0,0 +1,173 @@
+#include "ScriptBlocksColorsUpdater.h"
+
+#include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+#include <BusinessLayer/ScenarioDocument/ScriptTextCursor.h>
+
+#include <QElapsedTimer>
+#include <QTextBlock>
+#include <QTextDocument>
+
+using ManagementLayer::ScriptBlocksColorsUpdater;
+using BusinessLogic::ScenarioBlockStyle;
+using BusinessLogic::ScriptTextCursor;
+
+namespace {
+    /**
+     * @brief Длительность обработки одной порции блоков, мс
+     * @note Выбрана так, чтобы между порциями успевала отрисоваться пара кадров
+     */
+    const int SLICE_DURATION = 8;
+}
+
+
+ScriptBlocksColorsUpdater* ScriptBlocksColorsUpdater::forDocument(QTextDocument* _document)
+{
+    Q_ASSERT(_document);
+
+    ScriptBlocksColorsUpdater* updater =
+            _document->findChild<ScriptBlocksColorsUpdater*>(QString(), Qt::FindDirectChildrenOnly);
+    if (updater == nullptr) {
+        updater = new ScriptBlocksColorsUpdater(_document);
+    }
+    return updater;
+}
+
+void ScriptBlocksColorsUpdater::update(int _visibleFrom, int _visibleTo)
+{
+    m_sliceTimer.stop();
+    m_pendingRanges.clear();
+
+    const int documentEnd = m_document->characterCount() - 1;
+    if (_visibleFrom < 0 || _visibleTo < _visibleFrom) {
+        appendPendingRange(0, documentEnd);
+    } else {
+        //
+        // Видимые блоки обновляем сразу, чтобы пользователь не видел смешения старых и новых цветов
+        //
+        QTextBlock firstVisibleBlock = m_document->findBlock(_visibleFrom);
+        if (!firstVisibleBlock.isValid()) {
+            firstVisibleBlock = m_document->firstBlock();
+        }
+        QTextBlock lastVisibleBlock = m_document->findBlock(_visibleTo);
+        if (!lastVisibleBlock.isValid()) {
+            lastVisibleBlock = m_document->lastBlock();
+        }
+
+        ScriptTextCursor cursor(m_document);
+        cursor.beginEditBlock();
+        QTextBlock block = firstVisibleBlock;
+        while (block.isValid() && block.blockNumber() <= lastVisibleBlock.blockNumber()) {
+            updateBlock(cursor, block);
+            block = block.next();
+        }
+        cursor.endEditBlock();
+
+        //
+        // ... затем то, что ниже видимой части, т.к. обычно текст листают вниз, и в последнюю очередь начало
+        //
+        if (lastVisibleBlock.next().isValid()) {
+            appendPendingRange(lastVisibleBlock.next().position(), documentEnd);
+        }
+        if (firstVisibleBlock.previous().isValid()) {
+            appendPendingRange(0, firstVisibleBlock.position() - 1);
+        }
+    }
+
+    if (!m_pendingRanges.isEmpty()) {
+        m_sliceTimer.start();
+    }
+}
+
+bool ScriptBlocksColorsUpdater::isRunning() const
+{
+    return !m_pendingRanges.isEmpty();
+}
+
+ScriptBlocksColorsUpdater::ScriptBlocksColorsUpdater(QTextDocument* _document) :
+    QObject(_document),
+    m_document(_document)
+{
+    m_sliceTimer.setSingleShot(true);
+    m_sliceTimer.setInterval(0);
+    connect(&m_sliceTimer, &QTimer::timeout, this, &ScriptBlocksColorsUpdater::processNextSlice);
+}
+
+void ScriptBlocksColorsUpdater::processNextSlice()
+{
+    QElapsedTimer sliceTimer;
+    sliceTimer.start();
+
+    //
+    // Между порциями документ мог быть изменён пользователем, но границы диапазонов смещаются
+    // вместе с текстом, поэтому ни один из ожидающих блоков не будет пропущен
+    //
+    ScriptTextCursor cursor(m_document);
+    cursor.beginEditBlock();
+    while (!m_pendingRanges.isEmpty()
+           && sliceTimer.elapsed() < SLICE_DURATION) {
+        PendingRange& range = m_pendingRanges.first();
+
+        QTextBlock block = m_document->findBlock(range.from.position());
+        while (block.isValid()
+               && block.position() <= range.to.position()
+               && sliceTimer.elapsed() < SLICE_DURATION) {
+            updateBlock(cursor, block);
+            block = block.next();
+        }
+
+        if (!block.isValid() || block.position() > range.to.position()) {
+            m_pendingRanges.removeFirst();
+        } else {
+            range.from.setPosition(block.position());
+        }
+    }
+    cursor.endEditBlock();
+
+    if (!m_pendingRanges.isEmpty()) {
+        m_sliceTimer.start();
+    }
+}
+
+void ScriptBlocksColorsUpdater::updateBlock(QTextCursor& _cursor, const QTextBlock& _block) const
+{
+    const ScenarioBlockStyle blockStyle = BusinessLogic::ScenarioTemplateFacade::getTemplate().blockStyle(_block);
+
+    //
+    // Если в блоке есть выделения, обновляем цвет только тех частей, которые не входят в выделения
+    //
+    for (const QTextLayout::FormatRange& range : _block.textFormats()) {
+        if (!range.format.boolProperty(ScenarioBlockStyle::PropertyIsReviewMark)) {
+            auto charFormat = blockStyle.charFormat();
+            if (range.format.font().bold()) {
+                charFormat.setFontWeight(QFont::Bold);
+            }
+            if (range.format.font().italic()) {
+                charFormat.setFontItalic(true);
+            }
+            if (range.format.font().underline()) {
+                charFormat.setFontUnderline(true);
+            }
+            _cursor.setPosition(_block.position() + range.start);
+            _cursor.setPosition(_cursor.position() + range.length, QTextCursor::KeepAnchor);
+            _cursor.mergeCharFormat(charFormat);
+        }
+    }
+
+    _cursor.setPosition(_block.position() + _block.length() - 1);
+    _cursor.mergeBlockCharFormat(blockStyle.charFormat());
+    _cursor.mergeBlockFormat(blockStyle.blockFormat());
+}
+
+void ScriptBlocksColorsUpdater::appendPendingRange(int _from, int _to)
+{
+    PendingRange range;
+    range.from = QTextCursor(m_document);
+    range.from.setPosition(_from);
+    //
+    // ... текст, вставленный прямо в начало диапазона, тоже должен попасть в обновление
+    //
+    range.from.setKeepPositionOnInsert(true);
+    range.to = QTextCursor(m_document);
+    range.to.setPosition(_to);
+    m_pendingRanges.append(range);
+}
@@ -0,0 +1,91 @@
+#ifndef SCRIPTBLOCKSCOLORSUPDATER_H
+#define SCRIPTBLOCKSCOLORSUPDATER_H
+
+#include <QObject>
+#include <QTextCursor>
+#include <QTimer>
+#include <QVector>
+
+class QTextBlock;
+class QTextDocument;
+
+
+namespace ManagementLayer
+{
+    /**
+     * @brief Обновляет цвета текста и фона блоков документа сценария после смены настроек
+     * @note Сначала синхронно обновляются блоки, видимые в редакторе, а остальные
+     *       обновляются порциями в цикле событий, чтобы не блокировать интерфейс на больших сценариях
+     */
+    class ScriptBlocksColorsUpdater : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @brief Получить обработчик документа, при необходимости он будет создан
+         * @note Обработчик принадлежит документу и удаляется вместе с ним
+         */
+        static ScriptBlocksColorsUpdater* forDocument(QTextDocument* _document);
+
+    public:
+        /**
+         * @brief Обновить цвета всех блоков документа
+         * @param _visibleFrom, _visibleTo - диапазон позиций видимого текста, он обновляется сразу,
+         *        если диапазон не задан, весь документ обновляется порциями
+         * @note Незавершённое предыдущее обновление отменяется
+         */
+        void update(int _visibleFrom = -1, int _visibleTo = -1);
+
+        /**
+         * @brief Есть ли блоки, ожидающие обновления
+         */
+        bool isRunning() const;
+
+    private:
+        explicit ScriptBlocksColorsUpdater(QTextDocument* _document);
+
+        /**
+         * @brief Обновить очередную порцию блоков
+         */
+        void processNextSlice();
+
+        /**
+         * @brief Обновить цвета заданного блока
+         */
+        void updateBlock(QTextCursor& _cursor, const QTextBlock& _block) const;
+
+        /**
+         * @brief Добавить в очередь на обновление блоки между заданными позициями
+         */
+        void appendPendingRange(int _from, int _to);
+
+    private:
+        /**
+         * @brief Документ, блоки которого обновляются
+         */
+        QTextDocument* m_document = nullptr;
+
+        /**
+         * @brief Диапазон текста, ожидающий обновления
+         * @note Границы хранятся курсорами, чтобы они смещались вместе с текстом,
+         *       если пользователь правит документ между порциями
+         */
+        struct PendingRange {
+            QTextCursor from;
+            QTextCursor to;
+        };
+
+        /**
+         * @brief Диапазоны текста, ожидающие обновления, в порядке обработки
+         */
+        QVector<PendingRange> m_pendingRanges;
+
+        /**
+         * @brief Таймер запуска обработки очередной порции
+         */
+        QTimer m_sliceTimer;
+    };
+}
+
+#endif // SCRIPTBLOCKSCOLORSUPDATER_H
@@ -0,0 +1,357 @@
+#include "ScriptChronometryIndex.h"
+
+#include <BusinessLayer/Chronometry/ChronometerFacade.h>
+#include <BusinessLayer/Chronometry/PagesChronometer.h>
+
+#include <DataLayer/DataStorageLayer/StorageFacade.h>
+#include <DataLayer/DataStorageLayer/SettingsStorage.h>
+
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include <algorithm>
+
+using ManagementLayer::ScriptChronometryIndex;
+
+namespace {
+    /**
+     * @brief Количество блоков во фрагменте при построении индекса
+     * @note Фрагмент, выросший при вставке больше чем вдвое, делится на фрагменты этого размера
+     */
+    const int BLOCKS_IN_CHUNK = 64;
+
+    /**
+     * @brief Добавить значение к элементу дерева Фенвика
+     */
+    template<typename T>
+    static void treeAdd(QVector<T>& _tree, int _index, T _delta) {
+        for (int index = _index + 1; index < _tree.size(); index += index & -index) {
+            _tree[index] += _delta;
+        }
+    }
+
+    /**
+     * @brief Сумма элементов дерева Фенвика, индексы которых меньше заданного
+     */
+    template<typename T>
+    static T treePrefix(const QVector<T>& _tree, int _count) {
+        T result = 0;
+        for (int index = std::min(_count, _tree.size() - 1); index > 0; index -= index & -index) {
+            result += _tree.at(index);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Построить дерево Фенвика за линейное время, перенося каждую сумму в ближайшего родителя
+     */
+    template<typename T>
+    static void treeBuild(QVector<T>& _tree, const QVector<T>& _values) {
+        _tree.fill(0, _values.size() + 1);
+        for (int index = 1; index < _tree.size(); ++index) {
+            _tree[index] += _values.at(index - 1);
+            const int parent = index + (index & -index);
+            if (parent < _tree.size()) {
+                _tree[parent] += _tree.at(index);
+            }
+        }
+    }
+}
+
+
+bool ScriptChronometryIndex::isApplicable()
+{
+    const QString chronometryType =
+            DataStorageLayer::StorageFacade::settingsStorage()->value(
+                "chronometry/current-chronometer-type",
+                DataStorageLayer::SettingsStorage::ApplicationSettings);
+    return chronometryType != BusinessLogic::PagesChronometer().name();
+}
+
+ScriptChronometryIndex* ScriptChronometryIndex::forDocument(QTextDocument* _document)
+{
+    Q_ASSERT(_document);
+
+    ScriptChronometryIndex* index =
+            _document->findChild<ScriptChronometryIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (index == nullptr) {
+        index = new ScriptChronometryIndex(_document);
+    }
+    return index;
+}
+
+void ScriptChronometryIndex::invalidate(QTextDocument* _document)
+{
+    Q_ASSERT(_document);
+
+    delete _document->findChild<ScriptChronometryIndex*>(QString(), Qt::FindDirectChildrenOnly);
+}
+
+qreal ScriptChronometryIndex::durationAtPosition(int _position) const
+{
+    const QTextBlock block = m_document->findBlock(_position);
+    if (!block.isValid()) {
+        return fullDuration();
+    }
+
+    //
+    // Длительность предшествующих блоков берём из индекса, а текущий блок считаем до позиции
+    //
+    qreal duration = prefixDuration(block.blockNumber());
+    if (_position > block.position()) {
+        duration += BusinessLogic::ChronometerFacade::calculate(m_document, block.position(), _position);
+    }
+    return duration;
+}
+
+qreal ScriptChronometryIndex::fullDuration() const
+{
+    return treePrefix(m_durationsTree, m_chunks.size());
+}
+
+ScriptChronometryIndex::ScriptChronometryIndex(QTextDocument* _document) :
+    QObject(_document),
+    m_document(_document)
+{
+    rebuild();
+
+    connect(m_document, &QTextDocument::contentsChange, this, &ScriptChronometryIndex::aboutContentsChange);
+}
+
+void ScriptChronometryIndex::rebuild()
+{
+    m_chunks.clear();
+    m_chunksDurations.clear();
+    m_chunks.append(QVector<qreal>());
+    m_chunksDurations.append(0);
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next()) {
+        if (m_chunks.last().size() == BLOCKS_IN_CHUNK) {
+            m_chunks.append(QVector<qreal>());
+            m_chunksDurations.append(0);
+        }
+        const qreal duration = blockDuration(block);
+        m_chunks.last().append(duration);
+        m_chunksDurations.last() += duration;
+    }
+    m_blocksCount = m_document->blockCount();
+    buildTrees();
+}
+
+void ScriptChronometryIndex::aboutContentsChange(int _position, int _charsRemoved, int _charsAdded)
+{
+    Q_UNUSED(_charsRemoved);
+
+    //
+    // Определяем диапазон блоков, которые затронуло изменение
+    //
+    QTextBlock firstBlock = m_document->findBlock(_position);
+    if (!firstBlock.isValid()) {
+        firstBlock = m_document->lastBlock();
+    }
+    QTextBlock lastBlock = m_document->findBlock(_position + _charsAdded);
+    if (!lastBlock.isValid()) {
+        lastBlock = m_document->lastBlock();
+    }
+
+    //
+    // ... и сколько блоков занимал этот диапазон до изменения
+    //
+    const int firstBlockNumber = firstBlock.blockNumber();
+    const int newBlocksCount = lastBlock.blockNumber() - firstBlockNumber + 1;
+    const int removedBlocksCount = newBlocksCount - (m_document->blockCount() - m_blocksCount);
+    if (removedBlocksCount < 0
+        || firstBlockNumber + removedBlocksCount > m_blocksCount) {
+        rebuild();
+        return;
+    }
+
+    //
+    // Блоки, которые были и до изменения, обновляем по месту, а недостающие вставляем,
+    // или лишние удаляем, не трогая остальную часть индекса
+    //
+    const int updatedBlocksCount = std::min(newBlocksCount, removedBlocksCount);
+    QTextBlock block = firstBlock;
+    for (int blockNumber = firstBlockNumber; blockNumber < firstBlockNumber + updatedBlocksCount; ++blockNumber) {
+        updateBlockDuration(blockNumber, blockDuration(block));
+        block = block.next();
+    }
+
+    if (removedBlocksCount > updatedBlocksCount) {
+        removeBlocks(firstBlockNumber + updatedBlocksCount, removedBlocksCount - updatedBlocksCount);
+    } else if (newBlocksCount > updatedBlocksCount) {
+        QVector<qreal> durations;
+        durations.reserve(newBlocksCount - updatedBlocksCount);
+        for (int blockNumber = updatedBlocksCount; blockNumber < newBlocksCount; ++blockNumber) {
+            durations.append(blockDuration(block));
+            block = block.next();
+        }
+        insertBlocks(firstBlockNumber + updatedBlocksCount, durations);
+    }
+}
+
+qreal ScriptChronometryIndex::blockDuration(const QTextBlock& _block) const
+{
+    return BusinessLogic::ChronometerFacade::calculate(m_document, _block.position(),
+                                                       _block.position() + _block.length() - 1);
+}
+
+void ScriptChronometryIndex::locateBlock(int _blockNumber, int& _chunkIndex, int& _blockIndex) const
+{
+    //
+    // Спускаемся по дереву количеств, пропуская фрагменты, которые целиком лежат до искомого блока
+    //
+    int step = 1;
+    while (step * 2 < m_blocksCountTree.size()) {
+        step *= 2;
+    }
+    int chunkIndex = 0;
+    int blockIndex = _blockNumber;
+    for (; step > 0; step /= 2) {
+        if (chunkIndex + step < m_blocksCountTree.size()
+            && m_blocksCountTree.at(chunkIndex + step) <= blockIndex) {
+            chunkIndex += step;
+            blockIndex -= m_blocksCountTree.at(chunkIndex);
+        }
+    }
+
+    if (chunkIndex >= m_chunks.size()) {
+        chunkIndex = m_chunks.size() - 1;
+        blockIndex = m_chunks.last().size();
+    }
+    _chunkIndex = chunkIndex;
+    _blockIndex = blockIndex;
+}
+
+void ScriptChronometryIndex::updateBlockDuration(int _blockNumber, qreal _duration)
+{
+    int chunkIndex = 0;
+    int blockIndex = 0;
+    locateBlock(_blockNumber, chunkIndex, blockIndex);
+
+    qreal& duration = m_chunks[chunkIndex][blockIndex];
+    const qreal delta = _duration - duration;
+    if (qFuzzyIsNull(delta)) {
+        return;
+    }
+
+    duration = _duration;
+    m_chunksDurations[chunkIndex] += delta;
+    treeAdd(m_durationsTree, chunkIndex, delta);
+}
+
+void ScriptChronometryIndex::insertBlocks(int _blockNumber, const QVector<qreal>& _durations)
+{
+    int chunkIndex = 0;
+    int blockIndex = 0;
+    locateBlock(_blockNumber, chunkIndex, blockIndex);
+
+    QVector<qreal>& chunk = m_chunks[chunkIndex];
+    qreal insertedDuration = 0;
+    for (int index = 0; index < _durations.size(); ++index) {
+        chunk.insert(blockIndex + index, _durations.at(index));
+        insertedDuration += _durations.at(index);
+    }
+    m_blocksCount += _durations.size();
+    m_chunksDurations[chunkIndex] += insertedDuration;
+
+    //
+    // Фрагмент, выросший больше чем вдвое, делим на части по BLOCKS_IN_CHUNK блоков. При этом
+    // меняется количество фрагментов и деревья строятся заново по суммам фрагментов
+    //
+    if (chunk.size() > BLOCKS_IN_CHUNK * 2) {
+        QVector<QVector<qreal>> parts;
+        QVector<qreal> partsDurations;
+        for (int index = 0; index < chunk.size(); index += BLOCKS_IN_CHUNK) {
+            parts.append(chunk.mid(index, BLOCKS_IN_CHUNK));
+            qreal partDuration = 0;
+            for (qreal blockDuration : parts.last()) {
+                partDuration += blockDuration;
+            }
+            partsDurations.append(partDuration);
+        }
+        m_chunks.remove(chunkIndex);
+        m_chunksDurations.remove(chunkIndex);
+        for (int index = 0; index < parts.size(); ++index) {
+            m_chunks.insert(chunkIndex + index, parts.at(index));
+            m_chunksDurations.insert(chunkIndex + index, partsDurations.at(index));
+        }
+        buildTrees();
+        return;
+    }
+
+    treeAdd(m_blocksCountTree, chunkIndex, _durations.size());
+    treeAdd(m_durationsTree, chunkIndex, insertedDuration);
+}
+
+void ScriptChronometryIndex::removeBlocks(int _blockNumber, int _count)
+{
+    bool hasEmptyChunks = false;
+    while (_count > 0) {
+        int chunkIndex = 0;
+        int blockIndex = 0;
+        locateBlock(_blockNumber, chunkIndex, blockIndex);
+
+        QVector<qreal>& chunk = m_chunks[chunkIndex];
+        const int removeCount = std::min(_count, chunk.size() - blockIndex);
+        if (removeCount <= 0) {
+            break;
+        }
+        qreal removedDuration = 0;
+        for (int index = blockIndex; index < blockIndex + removeCount; ++index) {
+            removedDuration += chunk.at(index);
+        }
+        chunk.remove(blockIndex, removeCount);
+        m_chunksDurations[chunkIndex] -= removedDuration;
+        treeAdd(m_blocksCountTree, chunkIndex, -removeCount);
+        treeAdd(m_durationsTree, chunkIndex, -removedDuration);
+        m_blocksCount -= removeCount;
+        _count -= removeCount;
+        hasEmptyChunks = hasEmptyChunks || chunk.isEmpty();
+    }
+
+    //
+    // Опустевшие фрагменты убираем один раз после удаления всех блоков
+    //
+    if (hasEmptyChunks) {
+        for (int chunkIndex = m_chunks.size() - 1; chunkIndex >= 0; --chunkIndex) {
+            if (m_chunks.at(chunkIndex).isEmpty()) {
+                m_chunks.remove(chunkIndex);
+                m_chunksDurations.remove(chunkIndex);
+            }
+        }
+        if (m_chunks.isEmpty()) {
+            m_chunks.append(QVector<qreal>());
+            m_chunksDurations.append(0);
+        }
+        buildTrees();
+    }
+}
+
+void ScriptChronometryIndex::buildTrees()
+{
+    QVector<int> blocksCounts;
+    blocksCounts.reserve(m_chunks.size());
+    for (const QVector<qreal>& chunk : m_chunks) {
+        blocksCounts.append(chunk.size());
+    }
+    treeBuild(m_durationsTree, m_chunksDurations);
+    treeBuild(m_blocksCountTree, blocksCounts);
+}
+
+qreal ScriptChronometryIndex::prefixDuration(int _blockNumber) const
+{
+    if (_blockNumber >= m_blocksCount) {
+        return fullDuration();
+    }
+
+    int chunkIndex = 0;
+    int blockIndex = 0;
+    locateBlock(_blockNumber, chunkIndex, blockIndex);
+
+    qreal duration = treePrefix(m_durationsTree, chunkIndex);
+    const QVector<qreal>& chunk = m_chunks.at(chunkIndex);
+    for (int index = 0; index < blockIndex; ++index) {
+        duration += chunk.at(index);
+    }
+    return duration;
+}
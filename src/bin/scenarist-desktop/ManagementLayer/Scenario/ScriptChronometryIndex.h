@@ -0,0 +1,141 @@
+#ifndef SCRIPTCHRONOMETRYINDEX_H
+#define SCRIPTCHRONOMETRYINDEX_H
+
+#include <QObject>
+#include <QVector>
+
+class QTextBlock;
+class QTextDocument;
+
+
+namespace ManagementLayer
+{
+    /**
+     * @brief Индекс хронометража блоков документа сценария
+     * @note Длительность каждого блока считается один раз и пересчитывается только при его изменении.
+     *       Длительности хранятся фрагментами по 64 блока, а суммы длительностей и количества блоков
+     *       фрагментов - в двух деревьях Фенвика, общих для всех фрагментов. Поэтому хронометраж до позиции,
+     *       а также вставка и удаление блоков обходятся логарифмическим от количества фрагментов временем
+     *       и проходом по одному фрагменту. Фрагмент, выросший больше 128 блоков, делится, а опустевший
+     *       удаляется, и тогда оба дерева строятся заново за линейное от количества фрагментов время
+     */
+    class ScriptChronometryIndex : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @brief Можно ли считать хронометраж текущей системы по индексу
+         * @note Хронометраж по страницам зависит от раскладки всего текста, а не складывается
+         *       из длительностей отдельных блоков, поэтому для него индекс не используется
+         */
+        static bool isApplicable();
+
+        /**
+         * @brief Получить индекс документа, при необходимости он будет создан
+         * @note Индекс принадлежит документу и удаляется вместе с ним
+         */
+        static ScriptChronometryIndex* forDocument(QTextDocument* _document);
+
+        /**
+         * @brief Удалить индекс документа, чтобы при следующем обращении он был построен заново
+         * @note Используется при смене параметров хронометража и шаблона сценария
+         */
+        static void invalidate(QTextDocument* _document);
+
+    public:
+        /**
+         * @brief Длительность сценария от начала до заданной позиции, сек
+         */
+        qreal durationAtPosition(int _position) const;
+
+        /**
+         * @brief Длительность всего сценария, сек
+         */
+        qreal fullDuration() const;
+
+    private:
+        explicit ScriptChronometryIndex(QTextDocument* _document);
+
+        /**
+         * @brief Рассчитать длительности всех блоков заново
+         */
+        void rebuild();
+
+        /**
+         * @brief Обновить индекс для изменившейся части документа
+         */
+        void aboutContentsChange(int _position, int _charsRemoved, int _charsAdded);
+
+        /**
+         * @brief Рассчитать длительность блока
+         */
+        qreal blockDuration(const QTextBlock& _block) const;
+
+        /**
+         * @brief Найти фрагмент, в котором находится блок с заданным номером, и положение блока в нём
+         * @note Для номера, следующего за последним блоком, возвращается конец последнего фрагмента
+         */
+        void locateBlock(int _blockNumber, int& _chunkIndex, int& _blockIndex) const;
+
+        /**
+         * @brief Изменить длительность блока с заданным номером
+         */
+        void updateBlockDuration(int _blockNumber, qreal _duration);
+
+        /**
+         * @brief Вставить блоки с заданными длительностями перед блоком с заданным номером
+         */
+        void insertBlocks(int _blockNumber, const QVector<qreal>& _durations);
+
+        /**
+         * @brief Удалить заданное количество блоков, начиная с блока с заданным номером
+         */
+        void removeBlocks(int _blockNumber, int _count);
+
+        /**
+         * @brief Построить деревья сумм по фрагментам
+         * @note Нужно только когда меняется количество фрагментов, строится по суммам фрагментов,
+         *       не обходя длительности блоков
+         */
+        void buildTrees();
+
+        /**
+         * @brief Суммарная длительность блоков, номера которых меньше заданного
+         */
+        qreal prefixDuration(int _blockNumber) const;
+
+    private:
+        /**
+         * @brief Документ, для которого строится индекс
+         */
+        QTextDocument* m_document = nullptr;
+
+        /**
+         * @brief Длительности блоков, разбитые на фрагменты по порядку блоков
+         */
+        QVector<QVector<qreal>> m_chunks;
+
+        /**
+         * @brief Суммарные длительности фрагментов
+         */
+        QVector<qreal> m_chunksDurations;
+
+        /**
+         * @brief Дерево Фенвика сумм длительностей фрагментов, индексы начинаются с единицы
+         */
+        QVector<qreal> m_durationsTree;
+
+        /**
+         * @brief Дерево Фенвика количеств блоков во фрагментах, индексы начинаются с единицы
+         */
+        QVector<int> m_blocksCountTree;
+
+        /**
+         * @brief Общее количество блоков в индексе
+         */
+        int m_blocksCount = 0;
+    };
+}
+
+#endif // SCRIPTCHRONOMETRYINDEX_H
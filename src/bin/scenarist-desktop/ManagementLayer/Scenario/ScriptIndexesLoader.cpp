@@ -0,0 +1,84 @@
+#include "ScriptIndexesLoader.h"
+
+#include "ScriptNamesIndex.h"
+
+#include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+
+#include <ManagementLayer/Tracing/Tracer.h>
+
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QtConcurrentRun>
+
+using ManagementLayer::ScriptIndexesLoader;
+using ManagementLayer::ScriptNamesIndex;
+using ManagementLayer::Tracer;
+using BusinessLogic::ScenarioBlockStyle;
+
+namespace {
+    /**
+     * @brief Копия блока документа, не связанная с ним
+     */
+    struct BlockSnapshot {
+        int type = ScenarioBlockStyle::Undefined;
+        QString text;
+    };
+
+    /**
+     * @brief Данные индексов, построенные в фоне
+     */
+    struct Indexes {
+        QVector<ScriptNamesIndex::Names> names;
+    };
+
+    /**
+     * @brief Построить индексы по копии блоков документа
+     */
+    static Indexes buildIndexes(const QVector<BlockSnapshot>& _blocks) {
+        const Tracer::Span span("ScriptIndexesLoader::buildIndexes");
+
+        Indexes indexes;
+        indexes.names.reserve(_blocks.size());
+        for (const BlockSnapshot& block : _blocks) {
+            indexes.names.append(ScriptNamesIndex::parseText(block.type, block.text));
+        }
+        return indexes;
+    }
+}
+
+
+void ScriptIndexesLoader::loadAsync(QTextDocument* _document)
+{
+    Q_ASSERT(_document);
+
+    //
+    // Снимаем копию блоков, чтобы фоновый поток не обращался к документу
+    //
+    QVector<BlockSnapshot> blocks;
+    blocks.reserve(_document->blockCount());
+    for (QTextBlock block = _document->begin(); block.isValid(); block = block.next()) {
+        BlockSnapshot snapshot;
+        snapshot.type = ScenarioBlockStyle::forBlock(block);
+        snapshot.text = block.text();
+        blocks.append(snapshot);
+    }
+
+    //
+    // Следим за изменениями документа, пока строятся индексы
+    //
+    QFutureWatcher<Indexes>* watcher = new QFutureWatcher<Indexes>(_document);
+    QSharedPointer<bool> isDocumentChanged(new bool(false));
+    QObject::connect(_document, &QTextDocument::contentsChange, watcher, [isDocumentChanged] {
+        *isDocumentChanged = true;
+    });
+    QObject::connect(watcher, &QFutureWatcher<Indexes>::finished, _document, [_document, watcher, isDocumentChanged] {
+        if (!*isDocumentChanged) {
+            const Indexes indexes = watcher->result();
+            ScriptNamesIndex::install(_document, indexes.names);
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(&buildIndexes, blocks));
+}
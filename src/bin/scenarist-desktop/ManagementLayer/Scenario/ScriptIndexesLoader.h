@@ -0,0 +1,28 @@
+#ifndef SCRIPTINDEXESLOADER_H
+#define SCRIPTINDEXESLOADER_H
+
+class QTextDocument;
+
+
+namespace ManagementLayer
+{
+    /**
+     * @brief Построитель индексов блоков документа сценария в фоновом потоке
+     * @note В потоке интерфейса снимается копия текста и типов блоков, разбор имён
+     *       выполняется в фоне, а готовые индексы подключаются к документу снова в потоке
+     *       интерфейса. Если документ за это время изменился, результат отбрасывается
+     *       и индексы строятся обычным образом при первом обращении
+     * @note В фон выносится только разбор имён, чтение проекта из базы данных и загрузка xml
+     *       сценария в документ выполняются библиотекой ядра в потоке интерфейса
+     */
+    class ScriptIndexesLoader
+    {
+    public:
+        /**
+         * @brief Запустить построение индексов документа
+         */
+        static void loadAsync(QTextDocument* _document);
+    };
+}
+
+#endif // SCRIPTINDEXESLOADER_H
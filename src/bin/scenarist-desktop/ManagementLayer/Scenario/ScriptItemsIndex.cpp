@@ -0,0 +1,166 @@
+#include "ScriptItemsIndex.h"
+
+#include <BusinessLayer/ScenarioDocument/ScenarioDocument.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioModel.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioModelItem.h>
+
+#include <QTextDocument>
+
+#include <algorithm>
+
+using ManagementLayer::ScriptItemsIndex;
+using BusinessLogic::ScenarioDocument;
+using BusinessLogic::ScenarioModel;
+using BusinessLogic::ScenarioModelItem;
+
+
+ScriptItemsIndex* ScriptItemsIndex::forScenario(ScenarioDocument* _scenario)
+{
+    Q_ASSERT(_scenario);
+
+    ScriptItemsIndex* index = _scenario->findChild<ScriptItemsIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (index == nullptr) {
+        index = new ScriptItemsIndex(_scenario);
+    }
+    return index;
+}
+
+QModelIndex ScriptItemsIndex::itemIndexAtPosition(int _position)
+{
+    prepare();
+
+    const int entry = entryAtPosition(_position);
+    return entry == -1 ? QModelIndex() : QModelIndex(m_entries.at(entry).index);
+}
+
+ScenarioModelItem* ScriptItemsIndex::itemAtPosition(int _position)
+{
+    const QModelIndex index = itemIndexAtPosition(_position);
+    return index.isValid() ? m_model->itemForIndex(index) : nullptr;
+}
+
+int ScriptItemsIndex::itemStartPosition(const QModelIndex& _index) const
+{
+    //
+    // Позиция начала хранится в самом элементе модели, поэтому искать её по тексту не нужно
+    //
+    return _index.isValid() ? m_model->itemForIndex(_index)->position() : 0;
+}
+
+ScriptItemsIndex::ScriptItemsIndex(ScenarioDocument* _scenario) :
+    QObject(_scenario),
+    m_model(_scenario->model())
+{
+    connect(_scenario->document(), &QTextDocument::contentsChange, this, &ScriptItemsIndex::aboutContentsChange);
+
+    //
+    // При изменении структуры модели индекс строится заново при следующем обращении
+    //
+    connect(m_model, &ScenarioModel::rowsInserted, this, &ScriptItemsIndex::invalidate);
+    connect(m_model, &ScenarioModel::rowsRemoved, this, &ScriptItemsIndex::invalidate);
+    connect(m_model, &ScenarioModel::rowsMoved, this, &ScriptItemsIndex::invalidate);
+    connect(m_model, &ScenarioModel::modelReset, this, &ScriptItemsIndex::invalidate);
+    connect(m_model, &ScenarioModel::layoutChanged, this, &ScriptItemsIndex::invalidate);
+}
+
+void ScriptItemsIndex::aboutContentsChange(int _position, int _charsRemoved, int _charsAdded)
+{
+    if (m_isRebuildNeeded) {
+        return;
+    }
+
+    //
+    // Элементы после удалённого фрагмента просто сдвигаются,
+    // а элементы, начинавшиеся внутри него, помечаются для перечитывания из модели
+    //
+    const int changeEnd = _position + _charsRemoved;
+    const int delta = _charsAdded - _charsRemoved;
+    const auto firstEntry =
+            std::lower_bound(m_entries.begin(), m_entries.end(), _position,
+                             [] (const Entry& _entry, int _position) { return _entry.position < _position; });
+    for (auto entry = firstEntry; entry != m_entries.end(); ++entry) {
+        if (entry->position > changeEnd) {
+            entry->position += delta;
+            continue;
+        }
+
+        const int entryNumber = static_cast<int>(entry - m_entries.begin());
+        m_dirtyFrom = m_dirtyFrom == -1 ? entryNumber : std::min(m_dirtyFrom, entryNumber);
+        m_dirtyTo = std::max(m_dirtyTo, entryNumber);
+    }
+}
+
+void ScriptItemsIndex::invalidate()
+{
+    m_isRebuildNeeded = true;
+}
+
+void ScriptItemsIndex::prepare()
+{
+    if (m_isRebuildNeeded) {
+        rebuild();
+        return;
+    }
+
+    if (m_dirtyFrom == -1) {
+        return;
+    }
+
+    //
+    // Перечитываем позиции изменённых элементов
+    //
+    for (int entryNumber = m_dirtyFrom; entryNumber <= m_dirtyTo; ++entryNumber) {
+        Entry& entry = m_entries[entryNumber];
+        if (!entry.index.isValid()) {
+            rebuild();
+            return;
+        }
+        entry.position = m_model->itemForIndex(entry.index)->position();
+    }
+
+    //
+    // ... и проверяем, что порядок элементов не нарушился
+    //
+    const int checkFrom = std::max(m_dirtyFrom - 1, 0);
+    const int checkTo = std::min(m_dirtyTo + 1, m_entries.size() - 1);
+    for (int entryNumber = checkFrom; entryNumber < checkTo; ++entryNumber) {
+        if (m_entries.at(entryNumber).position > m_entries.at(entryNumber + 1).position) {
+            rebuild();
+            return;
+        }
+    }
+
+    m_dirtyFrom = m_dirtyTo = -1;
+}
+
+void ScriptItemsIndex::rebuild()
+{
+    m_entries.clear();
+
+    QVector<QModelIndex> parents { QModelIndex() };
+    while (!parents.isEmpty()) {
+        const QModelIndex parentIndex = parents.takeLast();
+        for (int row = 0; row < m_model->rowCount(parentIndex); ++row) {
+            const QModelIndex index = m_model->index(row, 0, parentIndex);
+            parents.append(index);
+
+            Entry entry;
+            entry.position = m_model->itemForIndex(index)->position();
+            entry.index = index;
+            m_entries.append(entry);
+        }
+    }
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [] (const Entry& _lhs, const Entry& _rhs) { return _lhs.position < _rhs.position; });
+
+    m_isRebuildNeeded = false;
+    m_dirtyFrom = m_dirtyTo = -1;
+}
+
+int ScriptItemsIndex::entryAtPosition(int _position) const
+{
+    const auto nextEntry =
+            std::upper_bound(m_entries.begin(), m_entries.end(), _position,
+                             [] (int _position, const Entry& _entry) { return _position < _entry.position; });
+    return static_cast<int>(nextEntry - m_entries.begin()) - 1;
+}
@@ -0,0 +1,111 @@
+#ifndef SCRIPTITEMSINDEX_H
+#define SCRIPTITEMSINDEX_H
+
+#include <QObject>
+#include <QPersistentModelIndex>
+#include <QVector>
+
+namespace BusinessLogic {
+    class ScenarioDocument;
+    class ScenarioModel;
+    class ScenarioModelItem;
+}
+
+
+namespace ManagementLayer
+{
+    /**
+     * @brief Индекс позиций начала сцен и папок сценария
+     * @note Позиции хранятся отсортированными, поэтому элемент в позиции находится двоичным поиском.
+     *       При правке текста сдвигаются позиции элементов после изменённого фрагмента, а позиции
+     *       элементов внутри него перечитываются из модели только при следующем обращении.
+     *       Полностью индекс перестраивается лишь при изменении структуры модели
+     */
+    class ScriptItemsIndex : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @brief Получить индекс сценария, при необходимости он будет создан
+         * @note Индекс принадлежит сценарию и удаляется вместе с ним
+         */
+        static ScriptItemsIndex* forScenario(BusinessLogic::ScenarioDocument* _scenario);
+
+    public:
+        /**
+         * @brief Индекс элемента модели, в котором находится позиция
+         */
+        QModelIndex itemIndexAtPosition(int _position);
+
+        /**
+         * @brief Элемент модели, в котором находится позиция
+         */
+        BusinessLogic::ScenarioModelItem* itemAtPosition(int _position);
+
+        /**
+         * @brief Позиция начала элемента модели
+         */
+        int itemStartPosition(const QModelIndex& _index) const;
+
+    private:
+        explicit ScriptItemsIndex(BusinessLogic::ScenarioDocument* _scenario);
+
+        /**
+         * @brief Сдвинуть позиции элементов после изменённого фрагмента текста
+         */
+        void aboutContentsChange(int _position, int _charsRemoved, int _charsAdded);
+
+        /**
+         * @brief Пометить индекс для полного перестроения
+         */
+        void invalidate();
+
+        /**
+         * @brief Актуализировать индекс перед поиском
+         */
+        void prepare();
+
+        /**
+         * @brief Построить индекс заново по модели сценария
+         */
+        void rebuild();
+
+        /**
+         * @brief Номер последнего элемента, начинающегося не позже позиции, или -1
+         */
+        int entryAtPosition(int _position) const;
+
+    private:
+        /**
+         * @brief Элемент индекса
+         */
+        struct Entry {
+            int position = 0;
+            QPersistentModelIndex index;
+        };
+
+        /**
+         * @brief Модель сценария
+         */
+        BusinessLogic::ScenarioModel* m_model = nullptr;
+
+        /**
+         * @brief Элементы, отсортированные по позиции начала
+         */
+        QVector<Entry> m_entries;
+
+        /**
+         * @brief Необходимо ли перестроить индекс полностью
+         */
+        bool m_isRebuildNeeded = true;
+
+        /**
+         * @brief Диапазон номеров элементов, позиции которых нужно перечитать из модели
+         */
+        int m_dirtyFrom = -1;
+        int m_dirtyTo = -1;
+    };
+}
+
+#endif // SCRIPTITEMSINDEX_H
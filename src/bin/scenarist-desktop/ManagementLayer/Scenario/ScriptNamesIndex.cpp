@@ -0,0 +1,347 @@
+#include "ScriptNamesIndex.h"
+
+#include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioTextBlockParsers.h>
+
+#include <3rd_party/Helpers/TextEditHelper.h>
+
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include <algorithm>
+
+using ManagementLayer::ScriptNamesIndex;
+using BusinessLogic::ScenarioBlockStyle;
+
+namespace {
+    /**
+     * @brief Является ли символ в заданной позиции границей имени в списке участников сцены
+     */
+    static bool isNameBoundary(const QString& _text, int _position) {
+        if (_position < 0 || _position >= _text.length()) {
+            return true;
+        }
+
+        return _text.at(_position) == ' ' || _text.at(_position) == ',';
+    }
+
+    /**
+     * @brief Является ли символ в заданной позиции границей слова
+     */
+    static bool isWordBoundary(const QString& _text, int _position) {
+        if (_position < 0 || _position >= _text.length()) {
+            return true;
+        }
+
+        return !_text.at(_position).isLetterOrNumber();
+    }
+
+    /**
+     * @brief Найти позицию названия локации в заголовке сцены
+     * @note Локация следует за местом действия, отделённым точкой, поэтому ищем только после него
+     *       и только целое название, чтобы не заменить часть места действия или другого слова
+     */
+    static int locationPosition(const QString& _sceneHeading, const QString& _location) {
+        const QString placeSeparator = ". ";
+        const int placeEnd = _sceneHeading.indexOf(placeSeparator);
+        int position =
+                _sceneHeading.indexOf(_location,
+                                      placeEnd == -1 ? 0 : placeEnd + placeSeparator.length(),
+                                      Qt::CaseInsensitive);
+        while (position != -1) {
+            if (isWordBoundary(_sceneHeading, position - 1)
+                && isWordBoundary(_sceneHeading, position + _location.length())) {
+                return position;
+            }
+            position = _sceneHeading.indexOf(_location, position + 1, Qt::CaseInsensitive);
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Заменить текст в заданных позициях блока, начиная с конца, чтобы не сбивать позиции
+     */
+    static void replaceInBlock(QTextCursor& _cursor, const QTextBlock& _block, const QVector<int>& _positions,
+        int _length, const QString& _newText) {
+        for (int index = _positions.size() - 1; index >= 0; --index) {
+            _cursor.setPosition(_block.position() + _positions.at(index));
+            _cursor.setPosition(_cursor.position() + _length, QTextCursor::KeepAnchor);
+            _cursor.insertText(_newText);
+        }
+    }
+}
+
+
+ScriptNamesIndex* ScriptNamesIndex::forDocument(QTextDocument* _document)
+{
+    Q_ASSERT(_document);
+
+    ScriptNamesIndex* index = _document->findChild<ScriptNamesIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (index == nullptr) {
+        index = new ScriptNamesIndex(_document);
+    }
+    return index;
+}
+
+void ScriptNamesIndex::install(QTextDocument* _document, const QVector<Names>& _names)
+{
+    Q_ASSERT(_document);
+
+    if (_document->findChild<ScriptNamesIndex*>(QString(), Qt::FindDirectChildrenOnly) == nullptr) {
+        new ScriptNamesIndex(_document, &_names);
+    }
+}
+
+void ScriptNamesIndex::invalidate(QTextDocument* _document)
+{
+    Q_ASSERT(_document);
+
+    delete _document->findChild<ScriptNamesIndex*>(QString(), Qt::FindDirectChildrenOnly);
+}
+
+ScriptNamesIndex::Names ScriptNamesIndex::parseText(int _blockType, const QString& _text)
+{
+    Names names;
+    switch (_blockType) {
+        case ScenarioBlockStyle::Character: {
+            const QString name = BusinessLogic::CharacterParser::name(_text);
+            if (!name.isEmpty()) {
+                names.characters.append(name);
+            }
+            break;
+        }
+
+        case ScenarioBlockStyle::SceneCharacters: {
+            names.characters = BusinessLogic::SceneCharactersParser::characters(_text);
+            names.characters.removeDuplicates();
+            break;
+        }
+
+        case ScenarioBlockStyle::SceneHeading: {
+            names.location = BusinessLogic::SceneHeadingParser::locationName(_text);
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+
+    return names;
+}
+
+ScriptNamesIndex::~ScriptNamesIndex()
+{
+    qDeleteAll(m_blocks);
+}
+
+QSet<QString> ScriptNamesIndex::characters() const
+{
+    return QSet<QString>::fromList(m_characters.keys());
+}
+
+QSet<QString> ScriptNamesIndex::locations() const
+{
+    return QSet<QString>::fromList(m_locations.keys());
+}
+
+void ScriptNamesIndex::renameCharacter(const QString& _oldName, const QString& _newName)
+{
+    const QList<QTextBlock> blocks = blocksFor(m_characters, TextEditHelper::smartToUpper(_oldName));
+    if (blocks.isEmpty()) {
+        return;
+    }
+
+    //
+    // Все замены делаются одним действием, чтобы их можно было отменить разом
+    //
+    QTextCursor cursor(m_document);
+    cursor.beginEditBlock();
+    for (const QTextBlock& block : blocks) {
+        const QString text = block.text();
+        QVector<int> positions;
+        //
+        // В блоке персонажа имя встречается один раз, а остальное - это расширения реплики
+        //
+        if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Character) {
+            const int position = text.indexOf(_oldName, 0, Qt::CaseInsensitive);
+            if (position != -1) {
+                positions.append(position);
+            }
+        }
+        //
+        // В участниках сцены заменяем только целые имена, а не части других имён
+        //
+        else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneCharacters) {
+            int position = text.indexOf(_oldName, 0, Qt::CaseInsensitive);
+            while (position != -1) {
+                if (isNameBoundary(text, position - 1)
+                    && isNameBoundary(text, position + _oldName.length())) {
+                    positions.append(position);
+                }
+                position = text.indexOf(_oldName, position + _oldName.length(), Qt::CaseInsensitive);
+            }
+        }
+
+        replaceInBlock(cursor, block, positions, _oldName.length(), _newName);
+    }
+    cursor.endEditBlock();
+}
+
+void ScriptNamesIndex::renameLocation(const QString& _oldName, const QString& _newName)
+{
+    const QList<QTextBlock> blocks = blocksFor(m_locations, TextEditHelper::smartToUpper(_oldName));
+    if (blocks.isEmpty()) {
+        return;
+    }
+
+    QTextCursor cursor(m_document);
+    cursor.beginEditBlock();
+    for (const QTextBlock& block : blocks) {
+        if (ScenarioBlockStyle::forBlock(block) != ScenarioBlockStyle::SceneHeading) {
+            continue;
+        }
+
+        const int position = locationPosition(block.text(), _oldName);
+        if (position != -1) {
+            replaceInBlock(cursor, block, { position }, _oldName.length(), _newName);
+        }
+    }
+    cursor.endEditBlock();
+}
+
+ScriptNamesIndex::ScriptNamesIndex(QTextDocument* _document, const QVector<Names>* _names) :
+    QObject(_document),
+    m_document(_document)
+{
+    if (_names != nullptr
+        && _names->size() == m_document->blockCount()) {
+        insertBlocks(0, m_document->begin(), m_document->blockCount(), _names);
+    } else {
+        rebuild();
+    }
+
+    connect(m_document, &QTextDocument::contentsChange, this, &ScriptNamesIndex::aboutContentsChange);
+}
+
+void ScriptNamesIndex::aboutContentsChange(int _position, int _charsRemoved, int _charsAdded)
+{
+    Q_UNUSED(_charsRemoved);
+
+    //
+    // Определяем диапазон блоков, которые затронуло изменение
+    //
+    QTextBlock firstBlock = m_document->findBlock(_position);
+    if (!firstBlock.isValid()) {
+        firstBlock = m_document->lastBlock();
+    }
+    QTextBlock lastBlock = m_document->findBlock(_position + _charsAdded);
+    if (!lastBlock.isValid()) {
+        lastBlock = m_document->lastBlock();
+    }
+
+    //
+    // ... и сколько блоков занимал этот диапазон до изменения
+    //
+    const int firstBlockNumber = firstBlock.blockNumber();
+    const int newBlocksCount = lastBlock.blockNumber() - firstBlockNumber + 1;
+    const int removedBlocksCount = newBlocksCount - (m_document->blockCount() - m_blocks.size());
+    if (removedBlocksCount < 0
+        || firstBlockNumber + removedBlocksCount > m_blocks.size()) {
+        //
+        // Изменение не удалось сопоставить с индексом, поэтому перестраиваем его целиком
+        //
+        rebuild();
+        return;
+    }
+
+    //
+    // Сперва добавляем новые блоки, а потом удаляем старые, чтобы не пересоздавать
+    // записи имён, которые остались в изменённых блоках
+    //
+    insertBlocks(firstBlockNumber, firstBlock, newBlocksCount);
+    removeBlocks(firstBlockNumber + newBlocksCount, removedBlocksCount);
+}
+
+void ScriptNamesIndex::rebuild()
+{
+    removeBlocks(0, m_blocks.size());
+    insertBlocks(0, m_document->begin(), m_document->blockCount());
+}
+
+void ScriptNamesIndex::insertBlocks(int _index, QTextBlock _block, int _count, const QVector<Names>* _names)
+{
+    m_blocks.insert(_index, _count, nullptr);
+    for (int index = _index; index < _index + _count && _block.isValid(); ++index) {
+        BlockNames* names = nullptr;
+        if (_names != nullptr) {
+            names = new BlockNames;
+            names->block = _block;
+            names->characters = _names->at(index - _index).characters;
+            names->location = _names->at(index - _index).location;
+        } else {
+            names = parseBlock(_block);
+        }
+        for (const QString& character : names->characters) {
+            m_characters[character].insert(names);
+        }
+        if (!names->location.isEmpty()) {
+            m_locations[names->location].insert(names);
+        }
+        m_blocks[index] = names;
+
+        _block = _block.next();
+    }
+}
+
+void ScriptNamesIndex::removeBlocks(int _index, int _count)
+{
+    auto unregister = [] (QHash<QString, QSet<BlockNames*>>& _names, const QString& _name, BlockNames* _block) {
+        auto iter = _names.find(_name);
+        if (iter != _names.end()) {
+            iter.value().remove(_block);
+            if (iter.value().isEmpty()) {
+                _names.erase(iter);
+            }
+        }
+    };
+
+    for (int index = _index; index < _index + _count; ++index) {
+        BlockNames* names = m_blocks.at(index);
+        if (names == nullptr) {
+            continue;
+        }
+
+        for (const QString& character : names->characters) {
+            unregister(m_characters, character, names);
+        }
+        if (!names->location.isEmpty()) {
+            unregister(m_locations, names->location, names);
+        }
+        delete names;
+    }
+    m_blocks.remove(_index, _count);
+}
+
+ScriptNamesIndex::BlockNames* ScriptNamesIndex::parseBlock(const QTextBlock& _block) const
+{
+    const Names parsed = parseText(ScenarioBlockStyle::forBlock(_block), _block.text());
+
+    BlockNames* names = new BlockNames;
+    names->block = _block;
+    names->characters = parsed.characters;
+    names->location = parsed.location;
+    return names;
+}
+
+QList<QTextBlock> ScriptNamesIndex::blocksFor(const QHash<QString, QSet<BlockNames*>>& _index, const QString& _name) const
+{
+    QList<QTextBlock> blocks;
+    for (const BlockNames* names : _index.value(_name)) {
+        blocks.append(names->block);
+    }
+    std::sort(blocks.begin(), blocks.end(), [] (const QTextBlock& _lhs, const QTextBlock& _rhs) {
+        return _lhs.position() < _rhs.position();
+    });
+    return blocks;
+}
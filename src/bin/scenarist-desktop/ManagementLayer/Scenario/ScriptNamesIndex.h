@@ -0,0 +1,149 @@
+#ifndef SCRIPTNAMESINDEX_H
+#define SCRIPTNAMESINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QTextBlock>
+#include <QVector>
+
+class QTextDocument;
+
+
+namespace ManagementLayer
+{
+    /**
+     * @brief Индекс вхождений имён персонажей и названий локаций в блоки документа сценария
+     * @note Индекс обновляется по сигналу QTextDocument::contentsChange и перечитывает только
+     *       изменившиеся блоки, поэтому для переименования не нужно искать по всему тексту
+     */
+    class ScriptNamesIndex : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @brief Получить индекс документа, при необходимости он будет создан
+         * @note Индекс принадлежит документу и удаляется вместе с ним
+         */
+        static ScriptNamesIndex* forDocument(QTextDocument* _document);
+
+        /**
+         * @brief Имена, упоминаемые в тексте блока
+         */
+        struct Names {
+            QStringList characters;
+            QString location;
+        };
+
+        /**
+         * @brief Создать индекс документа по заранее разобранным именам его блоков
+         * @note Если индекс уже создан, то ничего не делает
+         */
+        static void install(QTextDocument* _document, const QVector<Names>& _names);
+
+        /**
+         * @brief Удалить индекс документа, чтобы при следующем обращении он был построен заново
+         * @note Документы сценария используются повторно для каждого открываемого проекта, поэтому
+         *       индекс удаляется при закрытии проекта, иначе при открытии следующего он перечитывал бы
+         *       все загружаемые блоки в потоке интерфейса, а построенный в фоне индекс отбрасывался бы
+         */
+        static void invalidate(QTextDocument* _document);
+
+        /**
+         * @brief Разобрать имена в тексте блока заданного типа
+         * @note Не обращается к документу, поэтому может выполняться в любом потоке
+         */
+        static Names parseText(int _blockType, const QString& _text);
+
+    public:
+        ~ScriptNamesIndex();
+
+        /**
+         * @brief Персонажи, упоминаемые хотя бы в одном блоке документа
+         */
+        QSet<QString> characters() const;
+
+        /**
+         * @brief Локации, упоминаемые хотя бы в одном блоке документа
+         */
+        QSet<QString> locations() const;
+
+        /**
+         * @brief Переименовать персонажа во всех блоках, где он упоминается
+         */
+        void renameCharacter(const QString& _oldName, const QString& _newName);
+
+        /**
+         * @brief Переименовать локацию во всех блоках, где она упоминается
+         */
+        void renameLocation(const QString& _oldName, const QString& _newName);
+
+    private:
+        explicit ScriptNamesIndex(QTextDocument* _document, const QVector<Names>* _names = nullptr);
+
+        /**
+         * @brief Имена, упоминаемые в блоке
+         */
+        struct BlockNames {
+            QTextBlock block;
+            QStringList characters;
+            QString location;
+        };
+
+        /**
+         * @brief Обновить индекс для изменившейся части документа
+         */
+        void aboutContentsChange(int _position, int _charsRemoved, int _charsAdded);
+
+        /**
+         * @brief Построить индекс для всего документа заново
+         */
+        void rebuild();
+
+        /**
+         * @brief Добавить в индекс блоки документа, начиная с заданного, и поставить их в заданную позицию
+         * @param _names - заранее разобранные имена блоков, если не заданы, блоки разбираются заново
+         */
+        void insertBlocks(int _index, QTextBlock _block, int _count, const QVector<Names>* _names = nullptr);
+
+        /**
+         * @brief Удалить из индекса заданное количество блоков, начиная с заданной позиции
+         */
+        void removeBlocks(int _index, int _count);
+
+        /**
+         * @brief Сформировать список имён, упоминаемых в блоке
+         */
+        BlockNames* parseBlock(const QTextBlock& _block) const;
+
+        /**
+         * @brief Блоки, в которых упоминается заданное имя, в порядке следования в документе
+         */
+        QList<QTextBlock> blocksFor(const QHash<QString, QSet<BlockNames*>>& _index, const QString& _name) const;
+
+    private:
+        /**
+         * @brief Документ, для которого строится индекс
+         */
+        QTextDocument* m_document = nullptr;
+
+        /**
+         * @brief Имена в каждом из блоков документа, по номеру блока
+         */
+        QVector<BlockNames*> m_blocks;
+
+        /**
+         * @brief Блоки, в которых упоминается персонаж
+         * @note Имя хранится, пока на него ссылается хотя бы один блок
+         */
+        QHash<QString, QSet<BlockNames*>> m_characters;
+
+        /**
+         * @brief Блоки, в которых упоминается локация
+         */
+        QHash<QString, QSet<BlockNames*>> m_locations;
+    };
+}
+
+#endif // SCRIPTNAMESINDEX_H
@@ -0,0 +1,258 @@
+#include "ScriptPatchRebaser.h"
+
+#include <QRegularExpression>
+#include <QVector>
+
+#include <utility>
+
+using ManagementLayer::ScriptPatchRebaser;
+
+namespace {
+    /**
+     * @brief Признак начала заголовка фрагмента патча
+     */
+    const QString HUNK_HEADER_PREFIX = "@@ -";
+
+    /**
+     * @brief Фрагмент патча
+     * @note Позиции отсчитываются от нуля, start1 - в исходном тексте, start2 - в изменённом.
+     *       В тексте патча diff-match-patch каждый следующий фрагмент отсчитывает start1 от текста,
+     *       к которому уже применены предыдущие фрагменты, поэтому при разборе позиции переводятся
+     *       в координаты исходного текста, а при формировании текста патча - обратно
+     */
+    struct Hunk {
+        int start1 = 0;
+        int length1 = 0;
+        int start2 = 0;
+        int length2 = 0;
+
+        /**
+         * @brief Положение заголовка фрагмента в тексте патча
+         */
+        int headerPosition = 0;
+        int headerLength = 0;
+    };
+
+    /**
+     * @brief Разобранный патч
+     */
+    struct Patch {
+        bool isCompressed = false;
+        QString text;
+        QVector<Hunk> hunks;
+    };
+
+    /**
+     * @brief Разобрать координаты заголовка в формате diff-match-patch
+     */
+    static void parseCoordinates(const QString& _start, const QString& _length, int& _resultStart, int& _resultLength) {
+        _resultStart = _start.toInt();
+        if (_length.isEmpty()) {
+            --_resultStart;
+            _resultLength = 1;
+        } else if (_length == "0") {
+            _resultLength = 0;
+        } else {
+            --_resultStart;
+            _resultLength = _length.toInt();
+        }
+    }
+
+    /**
+     * @brief Сформировать координаты заголовка в формате diff-match-patch
+     */
+    static QString coordinates(int _start, int _length) {
+        if (_length == 0) {
+            return QString("%1,0").arg(_start);
+        } else if (_length == 1) {
+            return QString::number(_start + 1);
+        }
+        return QString("%1,%2").arg(_start + 1).arg(_length);
+    }
+
+    /**
+     * @brief Разобрать патч
+     */
+    static bool parsePatch(const QString& _patch, Patch& _result) {
+        _result.text = _patch;
+        if (!_result.text.startsWith(HUNK_HEADER_PREFIX)) {
+            _result.text = QString::fromUtf8(qUncompress(QByteArray::fromBase64(_patch.toUtf8())));
+            _result.isCompressed = true;
+            if (!_result.text.startsWith(HUNK_HEADER_PREFIX)) {
+                return false;
+            }
+        }
+
+        static const QRegularExpression s_headerRegExp("^@@ -(\\d+),?(\\d*) \\+(\\d+),?(\\d*) @@$",
+                                                       QRegularExpression::MultilineOption);
+        QRegularExpressionMatchIterator matches = s_headerRegExp.globalMatch(_result.text);
+        int appliedDelta = 0;
+        while (matches.hasNext()) {
+            const QRegularExpressionMatch match = matches.next();
+            Hunk hunk;
+            parseCoordinates(match.captured(1), match.captured(2), hunk.start1, hunk.length1);
+            parseCoordinates(match.captured(3), match.captured(4), hunk.start2, hunk.length2);
+            hunk.start1 -= appliedDelta;
+            appliedDelta += hunk.length2 - hunk.length1;
+            hunk.headerPosition = match.capturedStart();
+            hunk.headerLength = match.capturedLength();
+            _result.hunks.append(hunk);
+        }
+        return !_result.hunks.isEmpty();
+    }
+
+    /**
+     * @brief Сформировать текст патча с обновлёнными заголовками фрагментов
+     */
+    static QString patchText(const Patch& _patch) {
+        //
+        // ... позиции в исходном тексте переводим обратно в текст с применёнными предыдущими фрагментами
+        //
+        QVector<int> appliedDeltas(_patch.hunks.size());
+        int appliedDelta = 0;
+        for (int index = 0; index < _patch.hunks.size(); ++index) {
+            appliedDeltas[index] = appliedDelta;
+            appliedDelta += _patch.hunks.at(index).length2 - _patch.hunks.at(index).length1;
+        }
+
+        QString text = _patch.text;
+        for (int index = _patch.hunks.size() - 1; index >= 0; --index) {
+            const Hunk& hunk = _patch.hunks.at(index);
+            text.replace(hunk.headerPosition, hunk.headerLength,
+                         QString("@@ -%1 +%2 @@").arg(coordinates(hunk.start1 + appliedDeltas.at(index), hunk.length1),
+                                                      coordinates(hunk.start2, hunk.length2)));
+        }
+
+        if (_patch.isCompressed) {
+            text = QString::fromUtf8(qCompress(text.toUtf8()).toBase64());
+        }
+        return text;
+    }
+
+    /**
+     * @brief Сместить фрагменты патча так, будто он применяется после другого патча с тем же исходным текстом
+     * @note Позиции start1 обоих патчей заданы в координатах общего исходного текста
+     * @return false, если фрагменты патчей пересекаются
+     * @note Соприкасающиеся фрагменты тоже считаются пересекающимися, т.к. фрагменты содержат
+     *       окружающий текст, по которому патч ищет место применения
+     */
+    static bool shift(Patch& _patch, const Patch& _over) {
+        for (Hunk& hunk : _patch.hunks) {
+            int delta = 0;
+            for (const Hunk& overHunk : _over.hunks) {
+                if (overHunk.start1 + overHunk.length1 < hunk.start1) {
+                    delta += overHunk.length2 - overHunk.length1;
+                } else if (overHunk.start1 <= hunk.start1 + hunk.length1) {
+                    return false;
+                } else {
+                    break;
+                }
+            }
+            hunk.start1 += delta;
+            hunk.start2 += delta;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Обратить патч, чтобы он отменял изменения исходного
+     * @note Текст до и после изменения меняются местами, поэтому меняются местами и координаты фрагментов
+     */
+    static void invertPatch(Patch& _patch) {
+        QStringList lines = _patch.text.split('\n');
+        for (QString& line : lines) {
+            if (line.startsWith('-')) {
+                line[0] = '+';
+            } else if (line.startsWith('+')) {
+                line[0] = '-';
+            }
+        }
+        _patch.text = lines.join('\n');
+
+        for (Hunk& hunk : _patch.hunks) {
+            std::swap(hunk.start1, hunk.start2);
+            std::swap(hunk.length1, hunk.length2);
+        }
+    }
+}
+
+
+bool ScriptPatchRebaser::rebase(QStringList& _localPatches, QStringList& _remotePatches)
+{
+    QVector<Patch> localPatches(_localPatches.size());
+    for (int index = 0; index < _localPatches.size(); ++index) {
+        if (!parsePatch(_localPatches.at(index), localPatches[index])) {
+            return false;
+        }
+    }
+    QVector<Patch> remotePatches(_remotePatches.size());
+    for (int index = 0; index < _remotePatches.size(); ++index) {
+        if (!parsePatch(_remotePatches.at(index), remotePatches[index])) {
+            return false;
+        }
+    }
+
+    //
+    // Каждый пришедший патч проводим через все собственные изменения, одновременно смещая их самих,
+    // чтобы следующий пришедший патч проводился уже через изменения, выполненные после предыдущего
+    //
+    for (Patch& remotePatch : remotePatches) {
+        for (Patch& localPatch : localPatches) {
+            const Patch remotePatchBefore = remotePatch;
+            if (!shift(remotePatch, localPatch)
+                || !shift(localPatch, remotePatchBefore)) {
+                return false;
+            }
+        }
+    }
+
+    for (int index = 0; index < localPatches.size(); ++index) {
+        _localPatches[index] = patchText(localPatches.at(index));
+    }
+    for (int index = 0; index < remotePatches.size(); ++index) {
+        _remotePatches[index] = patchText(remotePatches.at(index));
+    }
+    return true;
+}
+
+bool ScriptPatchRebaser::toCommonBase(QStringList& _patches)
+{
+    QVector<Patch> patches(_patches.size());
+    for (int index = 0; index < _patches.size(); ++index) {
+        if (!parsePatch(_patches.at(index), patches[index])) {
+            return false;
+        }
+    }
+    QVector<Patch> invertedPatches = patches;
+    for (Patch& patch : invertedPatches) {
+        invertPatch(patch);
+    }
+
+    //
+    // Каждый патч проводим назад через отмены всех предшествующих ему патчей, от ближайшего к первому
+    //
+    QVector<Patch> result = patches;
+    for (int index = 1; index < result.size(); ++index) {
+        for (int previousIndex = index - 1; previousIndex >= 0; --previousIndex) {
+            if (!shift(result[index], invertedPatches.at(previousIndex))) {
+                return false;
+            }
+        }
+    }
+
+    for (int index = 0; index < result.size(); ++index) {
+        _patches[index] = patchText(result.at(index));
+    }
+    return true;
+}
+
+QString ScriptPatchRebaser::invert(const QString& _patch)
+{
+    Patch patch;
+    if (!parsePatch(_patch, patch)) {
+        return QString();
+    }
+
+    invertPatch(patch);
+    return patchText(patch);
+}
@@ -0,0 +1,44 @@
+#ifndef SCRIPTPATCHREBASER_H
+#define SCRIPTPATCHREBASER_H
+
+#include <QStringList>
+
+
+namespace ManagementLayer
+{
+    /**
+     * @brief Перенос патчей сценария друг поверх друга без применения их к документу
+     * @note Работает с патчами diff-match-patch, как сжатыми, так и в текстовом виде.
+     *       Меняются только позиции фрагментов патчей, поэтому перенос возможен лишь тогда,
+     *       когда фрагменты патчей не пересекаются
+     */
+    class ScriptPatchRebaser
+    {
+    public:
+        /**
+         * @brief Перенести пришедшие патчи поверх собственных изменений
+         * @param _localPatches - патчи собственных изменений, ещё не отправленных на сервер,
+         *        в порядке выполнения, после переноса они смещаются так, будто выполнены после пришедших
+         * @param _remotePatches - пришедшие патчи в порядке применения, после переноса
+         *        их можно применить к документу, содержащему собственные изменения
+         * @return false, если патчи пересекаются, или не удалось их разобрать, при этом списки не меняются
+         */
+        static bool rebase(QStringList& _localPatches, QStringList& _remotePatches);
+
+        /**
+         * @brief Перевести последовательно применяемые патчи к общему исходному тексту
+         * @note Каждый из полученных патчей можно проверить на применимость к тексту до первого патча,
+         *       сами патчи применяются по-прежнему последовательно
+         * @return false, если патчи пересекаются, или не удалось их разобрать, при этом список не меняется
+         */
+        static bool toCommonBase(QStringList& _patches);
+
+        /**
+         * @brief Сформировать патч, отменяющий заданный
+         * @return Пустую строку, если патч не удалось разобрать
+         */
+        static QString invert(const QString& _patch);
+    };
+}
+
+#endif // SCRIPTPATCHREBASER_H
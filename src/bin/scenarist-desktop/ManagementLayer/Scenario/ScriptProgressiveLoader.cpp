@@ -0,0 +1,339 @@
+#include "ScriptProgressiveLoader.h"
+
+
+#include <Domain/Scenario.h>
+
+#include <BusinessLayer/ScenarioDocument/ScenarioDocument.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioTextDocument.h>
+
+#include <DataLayer/DataStorageLayer/StorageFacade.h>
+#include <DataLayer/DataStorageLayer/ScenarioChangeStorage.h>
+
+#include <ManagementLayer/Tracing/Tracer.h>
+
+#include <QSignalBlocker>
+#include <QTextCursor>
+#include <QVector>
+#include <QXmlStreamReader>
+
+using ManagementLayer::ScriptProgressiveLoader;
+using BusinessLogic::ScenarioBlockStyle;
+
+namespace {
+    /**
+     * @brief Количество сцен до и после сцены с курсором, загружаемых сразу
+     * @note Сцена с курсором входит в сцены до него
+     */
+    /** @{ */
+    const int INITIAL_SCENES_BEFORE_CURSOR = 5;
+    const int INITIAL_SCENES_AFTER_CURSOR = 30;
+    /** @} */
+
+    /**
+     * @brief Количество сцен в одной догружаемой части
+     */
+    const int PART_SCENES = 40;
+
+    /**
+     * @brief Задержка между добавлением частей, мс
+     * @note Даёт циклу событий обработать ввод пользователя и отрисовку
+     */
+    const int PART_INTERVAL = 50;
+
+    /**
+     * @brief Тег, в котором хранится текст блока
+     */
+    const QString BLOCK_TEXT_TAG = "v";
+
+    /**
+     * @brief Блок верхнего уровня в xml сценария
+     */
+    struct XmlBlock {
+        int from = 0;
+        int to = 0;
+        int textLength = 0;
+        bool canSplitBefore = false;
+    };
+}
+
+
+ScriptProgressiveLoader::ScriptProgressiveLoader(QObject* _parent) :
+    QObject(_parent)
+{
+    m_partTimer.setSingleShot(true);
+    m_partTimer.setInterval(PART_INTERVAL);
+    connect(&m_partTimer, &QTimer::timeout, this, &ScriptProgressiveLoader::insertNextPart);
+}
+
+void ScriptProgressiveLoader::load(BusinessLogic::ScenarioDocument* _scenario, Domain::Scenario* _data,
+    int _cursorPosition)
+{
+    cancel();
+
+    m_scenario = _scenario;
+    const QString xml = _data->text();
+    if (!split(xml, _cursorPosition)) {
+        m_scenario->load(_data);
+        return;
+    }
+
+    //
+    // Загружаем начальную часть так же, как и сценарий целиком, но подставив вместо его текста
+    // только начало, после чего возвращаем сценарию полный текст
+    //
+    _data->setText(m_xmlHeader + m_initialPart + m_xmlFooter);
+    m_scenario->load(_data);
+    _data->setText(xml);
+    m_initialPart.clear();
+
+    m_partTimer.start();
+}
+
+int ScriptProgressiveLoader::toLoadedPosition(int _position) const
+{
+    return qMax(0, _position - m_unloadedPrefixLength);
+}
+
+int ScriptProgressiveLoader::toFullPosition(int _position) const
+{
+    return _position + m_unloadedPrefixLength;
+}
+
+bool ScriptProgressiveLoader::isRunning() const
+{
+    return !m_pendingParts.isEmpty();
+}
+
+bool ScriptProgressiveLoader::isInsertingPart() const
+{
+    return m_isInsertingPart;
+}
+
+void ScriptProgressiveLoader::finish()
+{
+    m_partTimer.stop();
+    while (isRunning()) {
+        insertNextPart();
+    }
+}
+
+void ScriptProgressiveLoader::cancel()
+{
+    m_partTimer.stop();
+    m_pendingParts.clear();
+    m_initialPart.clear();
+    m_unloadedPrefixLength = 0;
+}
+
+bool ScriptProgressiveLoader::split(const QString& _xml, int _cursorPosition)
+{
+    m_pendingParts.clear();
+
+    const QString sceneHeadingTag = ScenarioBlockStyle::typeName(ScenarioBlockStyle::SceneHeading);
+    const QString folderHeaderTag = ScenarioBlockStyle::typeName(ScenarioBlockStyle::FolderHeader);
+    const QString folderFooterTag = ScenarioBlockStyle::typeName(ScenarioBlockStyle::FolderFooter);
+
+    //
+    // Собираем блоки верхнего уровня с их границами в исходном тексте, разрезать текст можно
+    // только перед сценой или папкой, которые не вложены в другую папку
+    //
+    QVector<XmlBlock> blocks;
+    QString rootTag;
+    int headerEnd = 0;
+    int depth = 0;
+    int foldersDepth = 0;
+    bool isInsideBlockText = false;
+    qint64 tokenStart = 0;
+    QXmlStreamReader reader(_xml);
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+            case QXmlStreamReader::StartElement: {
+                if (depth == 0) {
+                    rootTag = reader.name().toString();
+                    headerEnd = reader.characterOffset();
+                } else if (depth == 1) {
+                    XmlBlock block;
+                    block.from = tokenStart;
+                    if (reader.name() == sceneHeadingTag) {
+                        block.canSplitBefore = foldersDepth == 0;
+                    } else if (reader.name() == folderHeaderTag) {
+                        block.canSplitBefore = foldersDepth == 0;
+                        ++foldersDepth;
+                    } else if (reader.name() == folderFooterTag) {
+                        --foldersDepth;
+                    }
+                    blocks.append(block);
+                } else if (depth == 2) {
+                    isInsideBlockText = reader.name() == BLOCK_TEXT_TAG;
+                }
+                ++depth;
+                break;
+            }
+
+            case QXmlStreamReader::EndElement: {
+                --depth;
+                if (depth == 1) {
+                    blocks.last().to = reader.characterOffset();
+                } else if (depth == 2) {
+                    isInsideBlockText = false;
+                }
+                break;
+            }
+
+            case QXmlStreamReader::Characters: {
+                if (isInsideBlockText) {
+                    blocks.last().textLength += reader.text().length();
+                }
+                break;
+            }
+
+            default: {
+                break;
+            }
+        }
+        tokenStart = reader.characterOffset();
+    }
+    if (reader.hasError()
+        || blocks.isEmpty()) {
+        return false;
+    }
+
+    //
+    // Определяем блок с курсором и границы начальной части, отсчитав заданное количество сцен до него и после
+    //
+    int cursorBlock = 0;
+    for (int position = 0; cursorBlock < blocks.size() - 1; ++cursorBlock) {
+        position += blocks.at(cursorBlock).textLength + 1;
+        if (position > _cursorPosition) {
+            break;
+        }
+    }
+    //
+    // ... границы частей после курсора идут по возрастанию
+    //
+    QVector<int> splitPointsAfter;
+    int scenesAfterCursor = 0;
+    for (int index = cursorBlock + 1; index < blocks.size(); ++index) {
+        if (!blocks.at(index).canSplitBefore) {
+            continue;
+        }
+
+        ++scenesAfterCursor;
+        if (scenesAfterCursor == INITIAL_SCENES_AFTER_CURSOR
+            || (scenesAfterCursor > INITIAL_SCENES_AFTER_CURSOR
+                && (scenesAfterCursor - INITIAL_SCENES_AFTER_CURSOR) % PART_SCENES == 0)) {
+            splitPointsAfter.append(index);
+        }
+    }
+    //
+    // ... а до курсора по убыванию
+    //
+    QVector<int> splitPointsBefore;
+    int scenesBeforeCursor = 0;
+    for (int index = cursorBlock; index > 0; --index) {
+        if (!blocks.at(index).canSplitBefore) {
+            continue;
+        }
+
+        ++scenesBeforeCursor;
+        if (scenesBeforeCursor == INITIAL_SCENES_BEFORE_CURSOR
+            || (scenesBeforeCursor > INITIAL_SCENES_BEFORE_CURSOR
+                && (scenesBeforeCursor - INITIAL_SCENES_BEFORE_CURSOR) % PART_SCENES == 0)) {
+            splitPointsBefore.append(index);
+        }
+    }
+    //
+    // ... если догружать нечего, то сценарий загрузится целиком
+    //
+    if (splitPointsAfter.isEmpty()
+        && splitPointsBefore.isEmpty()) {
+        return false;
+    }
+
+    m_xmlHeader = _xml.left(headerEnd);
+    m_xmlFooter = QString("</%1>").arg(rootTag);
+    const auto makePart = [&_xml, &blocks] (int _from, int _to, bool _isBeforeLoaded) {
+        Part part;
+        part.xml = _xml.mid(blocks.at(_from).from, blocks.at(_to - 1).to - blocks.at(_from).from);
+        for (int index = _from; index < _to; ++index) {
+            part.length += blocks.at(index).textLength + 1;
+        }
+        part.isBeforeLoaded = _isBeforeLoaded;
+        return part;
+    };
+    const int initialFrom = splitPointsBefore.isEmpty() ? 0 : splitPointsBefore.first();
+    const int initialTo = splitPointsAfter.isEmpty() ? blocks.size() : splitPointsAfter.first();
+    m_initialPart = makePart(initialFrom, initialTo, false).xml;
+    //
+    // ... сперва догружаем продолжение, т.к. сценарий обычно читают и пишут от начала к концу,
+    //     а затем начало, добавляя каждую часть перед уже загруженным текстом
+    //
+    for (int index = 0; index < splitPointsAfter.size(); ++index) {
+        const int to = index + 1 < splitPointsAfter.size() ? splitPointsAfter.at(index + 1) : blocks.size();
+        m_pendingParts.append(makePart(splitPointsAfter.at(index), to, false));
+    }
+    m_unloadedPrefixLength = 0;
+    for (int index = 0; index < splitPointsBefore.size(); ++index) {
+        const int from = index + 1 < splitPointsBefore.size() ? splitPointsBefore.at(index + 1) : 0;
+        m_pendingParts.append(makePart(from, splitPointsBefore.at(index), true));
+        m_unloadedPrefixLength += m_pendingParts.last().length;
+    }
+    return true;
+}
+
+void ScriptProgressiveLoader::insertNextPart()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    const Tracer::Span span("ScriptProgressiveLoader::insertNextPart");
+
+    const Part part = m_pendingParts.takeFirst();
+    BusinessLogic::ScenarioTextDocument* document = m_scenario->document();
+    {
+        //
+        // Добавление части не является правкой пользователя, поэтому сигналы об изменении текста
+        // документа не испускаем, а об изменениях в редакторе сообщаем флагом добавления части
+        //
+        QSignalBlocker signalBlocker(m_scenario);
+        m_isInsertingPart = true;
+
+        //
+        // Часть добавляем целыми блоками: в начале, или в конце документа отделяем новый пустой блок,
+        // который займёт первый блок части, чтобы он не слился с соседним загруженным блоком
+        //
+        QTextCursor cursor(document);
+        if (part.isBeforeLoaded) {
+            cursor.insertBlock();
+            cursor.movePosition(QTextCursor::Start);
+        } else {
+            cursor.movePosition(QTextCursor::End);
+            cursor.insertBlock();
+        }
+        document->insertFromMime(cursor.position(), m_xmlHeader + part.xml + m_xmlFooter);
+        m_isInsertingPart = false;
+    }
+    if (part.isBeforeLoaded) {
+        m_unloadedPrefixLength -= part.length;
+        emit partInsertedBefore();
+    }
+
+    if (isRunning()) {
+        m_partTimer.start();
+        return;
+    }
+
+    //
+    // Все части добавлены, фиксируем документ как совпадающий с сохранённым. Правок пользователя
+    // в нём нет, т.к. перед ними загрузка завершается, поэтому сформированное изменение содержит
+    // только догруженный текст и из истории его убираем
+    //
+    m_unloadedPrefixLength = 0;
+    if (document->saveChanges() != nullptr) {
+        DataStorageLayer::StorageFacade::scenarioChangeStorage()->removeLast();
+        document->updateUndoStack();
+    }
+    emit finished();
+}
@@ -0,0 +1,157 @@
+#ifndef SCRIPTPROGRESSIVELOADER_H
+#define SCRIPTPROGRESSIVELOADER_H
+
+#include <QObject>
+#include <QList>
+#include <QTimer>
+
+namespace BusinessLogic {
+    class ScenarioDocument;
+}
+
+namespace Domain {
+    class Scenario;
+}
+
+
+namespace ManagementLayer
+{
+    /**
+     * @brief Загрузчик больших сценариев по частям
+     * @note Сначала загружаются несколько сцен вокруг позиции курсора, чтобы с редактором можно было
+     *       работать сразу, а остальные сцены добавляются целыми блоками в конец и в начало документа
+     *       порциями в цикле событий. Документ фиксируется как совпадающий с сохранённым один раз,
+     *       когда добавлена последняя часть, поэтому до этого изменения сценария не сохраняются,
+     *       а перед правкой пользователя загрузку нужно завершить. Правка, сделанная в обход этого,
+     *       войдёт в загруженный текст и не попадёт в историю изменений
+     */
+    class ScriptProgressiveLoader : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit ScriptProgressiveLoader(QObject* _parent = nullptr);
+
+        /**
+         * @brief Загрузить сценарий в документ
+         * @param _cursorPosition - позиция курсора, вокруг которой текст нужен сразу
+         * @note Небольшие сценарии, а также сценарии, которые не удалось разбить на части,
+         *       загружаются целиком
+         */
+        void load(BusinessLogic::ScenarioDocument* _scenario, Domain::Scenario* _data, int _cursorPosition);
+
+        /**
+         * @brief Догружаются ли ещё части сценария
+         */
+        bool isRunning() const;
+
+        /**
+         * @brief Добавляется ли в документ очередная часть прямо сейчас
+         * @note Изменения текста, о которых в это время сообщает редактор, не являются правкой сценария
+         */
+        bool isInsertingPart() const;
+
+        /**
+         * @brief Догрузить все оставшиеся части сразу
+         */
+        void finish();
+
+        /**
+         * @brief Прекратить загрузку оставшихся частей
+         */
+        void cancel();
+
+        /**
+         * @brief Перевести позицию в полном сценарии в позицию в загруженной части и обратно
+         * @note Пока не загружено начало сценария, позиции загруженной части смещены
+         */
+        /** @{ */
+        int toLoadedPosition(int _position) const;
+        int toFullPosition(int _position) const;
+        /** @} */
+
+    signals:
+        /**
+         * @brief Добавлена часть сценария перед уже загруженным текстом
+         */
+        void partInsertedBefore();
+
+        /**
+         * @brief Сценарий загружен полностью
+         */
+        void finished();
+
+    private:
+        /**
+         * @brief Часть сценария, ожидающая добавления
+         */
+        struct Part {
+            /**
+             * @brief Xml блоков части
+             */
+            QString xml;
+
+            /**
+             * @brief Длина текста части в документе
+             */
+            int length = 0;
+
+            /**
+             * @brief Добавляется ли часть перед загруженным текстом
+             */
+            bool isBeforeLoaded = false;
+        };
+
+        /**
+         * @brief Разбить текст сценария на начальную часть и порции для догрузки
+         * @return Удалось ли разбить текст
+         */
+        bool split(const QString& _xml, int _cursorPosition);
+
+        /**
+         * @brief Добавить в документ очередную часть
+         */
+        void insertNextPart();
+
+    private:
+        /**
+         * @brief Загружаемый документ
+         */
+        BusinessLogic::ScenarioDocument* m_scenario = nullptr;
+
+        /**
+         * @brief Заголовок и завершение xml сценария, которыми обрамляется каждая часть
+         */
+        /** @{ */
+        QString m_xmlHeader;
+        QString m_xmlFooter;
+        /** @} */
+
+        /**
+         * @brief Начальная часть сценария
+         */
+        QString m_initialPart;
+
+        /**
+         * @brief Части сценария, ожидающие добавления, в порядке добавления
+         */
+        QList<Part> m_pendingParts;
+
+        /**
+         * @brief Длина ещё не загруженного начала сценария
+         */
+        int m_unloadedPrefixLength = 0;
+
+        /**
+         * @brief Добавляется ли часть в данный момент
+         */
+        bool m_isInsertingPart = false;
+
+        /**
+         * @brief Таймер добавления очередной части
+         */
+        QTimer m_partTimer;
+    };
+}
+
+#endif // SCRIPTPROGRESSIVELOADER_H
@@ -0,0 +1,178 @@
+#include "ScriptTextCountersIndex.h"
+
+#include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+
+#include <DataLayer/DataStorageLayer/StorageFacade.h>
+#include <DataLayer/DataStorageLayer/SettingsStorage.h>
+
+#include <QTextBlock>
+#include <QTextDocument>
+
+using ManagementLayer::ScriptTextCountersIndex;
+using BusinessLogic::ScenarioBlockStyle;
+
+
+ScriptTextCountersIndex::Counters& ScriptTextCountersIndex::Counters::operator+=(const Counters& _other)
+{
+    words += _other.words;
+    characters += _other.characters;
+    charactersWithoutSpaces += _other.charactersWithoutSpaces;
+    return *this;
+}
+
+ScriptTextCountersIndex::Counters& ScriptTextCountersIndex::Counters::operator-=(const Counters& _other)
+{
+    words -= _other.words;
+    characters -= _other.characters;
+    charactersWithoutSpaces -= _other.charactersWithoutSpaces;
+    return *this;
+}
+
+bool ScriptTextCountersIndex::isApplicable()
+{
+    return
+            DataStorageLayer::StorageFacade::settingsStorage()->value(
+                "counters/pages/used",
+                DataStorageLayer::SettingsStorage::ApplicationSettings).toInt() == false;
+}
+
+ScriptTextCountersIndex* ScriptTextCountersIndex::forDocument(QTextDocument* _document)
+{
+    Q_ASSERT(_document);
+
+    ScriptTextCountersIndex* index =
+            _document->findChild<ScriptTextCountersIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (index == nullptr) {
+        index = new ScriptTextCountersIndex(_document);
+    }
+    return index;
+}
+
+void ScriptTextCountersIndex::invalidate(QTextDocument* _document)
+{
+    Q_ASSERT(_document);
+
+    delete _document->findChild<ScriptTextCountersIndex*>(QString(), Qt::FindDirectChildrenOnly);
+}
+
+ScriptTextCountersIndex::Counters ScriptTextCountersIndex::total() const
+{
+    return m_total;
+}
+
+ScriptTextCountersIndex::ScriptTextCountersIndex(QTextDocument* _document) :
+    QObject(_document),
+    m_document(_document)
+{
+    rebuild();
+
+    connect(m_document, &QTextDocument::contentsChange, this, &ScriptTextCountersIndex::aboutContentsChange);
+}
+
+void ScriptTextCountersIndex::aboutContentsChange(int _position, int _charsRemoved, int _charsAdded)
+{
+    Q_UNUSED(_charsRemoved);
+
+    //
+    // Определяем диапазон блоков, которые затронуло изменение
+    //
+    QTextBlock firstBlock = m_document->findBlock(_position);
+    if (!firstBlock.isValid()) {
+        firstBlock = m_document->lastBlock();
+    }
+    QTextBlock lastBlock = m_document->findBlock(_position + _charsAdded);
+    if (!lastBlock.isValid()) {
+        lastBlock = m_document->lastBlock();
+    }
+
+    //
+    // ... и сколько блоков занимал этот диапазон до изменения
+    //
+    const int firstBlockNumber = firstBlock.blockNumber();
+    const int newBlocksCount = lastBlock.blockNumber() - firstBlockNumber + 1;
+    const int removedBlocksCount = newBlocksCount - (m_document->blockCount() - m_blocks.size());
+    if (removedBlocksCount < 0
+        || firstBlockNumber + removedBlocksCount > m_blocks.size()) {
+        rebuild();
+        return;
+    }
+
+    //
+    // Вычитаем из итогов старые значения изменённых блоков и добавляем новые
+    //
+    for (int index = firstBlockNumber; index < firstBlockNumber + removedBlocksCount; ++index) {
+        if (isCounted(m_blocks.at(index))) {
+            m_total -= m_blocks.at(index).counters;
+        }
+    }
+    m_blocks.remove(firstBlockNumber, removedBlocksCount);
+
+    m_blocks.insert(firstBlockNumber, newBlocksCount, BlockCounters());
+    QTextBlock block = firstBlock;
+    for (int index = firstBlockNumber; index < firstBlockNumber + newBlocksCount; ++index) {
+        m_blocks[index] = countBlock(block);
+        if (isCounted(m_blocks.at(index))) {
+            m_total += m_blocks.at(index).counters;
+        }
+        block = block.next();
+    }
+}
+
+void ScriptTextCountersIndex::rebuild()
+{
+    m_blocks.clear();
+    m_blocks.reserve(m_document->blockCount());
+    m_total = Counters();
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next()) {
+        m_blocks.append(countBlock(block));
+        if (isCounted(m_blocks.last())) {
+            m_total += m_blocks.last().counters;
+        }
+    }
+}
+
+ScriptTextCountersIndex::BlockCounters ScriptTextCountersIndex::countBlock(const QTextBlock& _block)
+{
+    BlockCounters block;
+
+    //
+    // Блоки коррекции разрывов страниц не содержат текста сценария, для них тип не учитывается
+    //
+    if (_block.blockFormat().boolProperty(ScenarioBlockStyle::PropertyIsCorrection)) {
+        block.type = ScenarioBlockStyle::NoprintableText;
+        return block;
+    }
+
+    block.type = ScenarioBlockStyle::forBlock(_block);
+    const QString text = _block.text();
+    bool isInsideWord = false;
+    for (const QChar& character : text) {
+        if (character.isSpace()) {
+            isInsideWord = false;
+        } else {
+            ++block.counters.charactersWithoutSpaces;
+            if (!isInsideWord) {
+                isInsideWord = true;
+                ++block.counters.words;
+            }
+        }
+    }
+    block.counters.characters = text.length();
+    return block;
+}
+
+bool ScriptTextCountersIndex::isCounted(const BlockCounters& _block)
+{
+    switch (_block.type) {
+        case ScenarioBlockStyle::NoprintableText:
+        case ScenarioBlockStyle::FolderHeader:
+        case ScenarioBlockStyle::FolderFooter:
+        case ScenarioBlockStyle::SceneDescription: {
+            return false;
+        }
+
+        default: {
+            return true;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef SCRIPTTEXTCOUNTERSINDEX_H
+#define SCRIPTTEXTCOUNTERSINDEX_H
+
+#include <QObject>
+#include <QVector>
+
+class QTextBlock;
+class QTextDocument;
+
+
+namespace ManagementLayer
+{
+    /**
+     * @brief Индекс счётчиков слов и символов блоков документа сценария
+     * @note Счётчики каждого блока хранятся вместе с его типом и пересчитываются только
+     *       для изменившихся блоков, а итоговые значения поддерживаются по мере правок
+     */
+    class ScriptTextCountersIndex : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @brief Счётчики текста
+         */
+        struct Counters {
+            int words = 0;
+            int characters = 0;
+            int charactersWithoutSpaces = 0;
+
+            Counters& operator+=(const Counters& _other);
+            Counters& operator-=(const Counters& _other);
+        };
+
+        /**
+         * @brief Счётчики блока
+         */
+        struct BlockCounters {
+            int type = 0;
+            Counters counters;
+        };
+
+    public:
+        /**
+         * @brief Можно ли выводить счётчики текущих настроек по индексу
+         * @note Количество страниц зависит от раскладки всего текста, а не складывается из
+         *       отдельных блоков, поэтому при включённом счётчике страниц индекс не используется
+         */
+        static bool isApplicable();
+
+        /**
+         * @brief Получить индекс документа, при необходимости он будет создан
+         * @note Индекс принадлежит документу и удаляется вместе с ним
+         */
+        static ScriptTextCountersIndex* forDocument(QTextDocument* _document);
+
+        /**
+         * @brief Удалить индекс документа, чтобы при следующем обращении он был построен заново
+         * @note Используется при закрытии проекта
+         */
+        static void invalidate(QTextDocument* _document);
+
+    public:
+        /**
+         * @brief Счётчики по всем блокам, которые выводятся при печати
+         */
+        Counters total() const;
+
+    private:
+        explicit ScriptTextCountersIndex(QTextDocument* _document);
+
+        /**
+         * @brief Обновить индекс для изменившейся части документа
+         */
+        void aboutContentsChange(int _position, int _charsRemoved, int _charsAdded);
+
+        /**
+         * @brief Построить индекс для всего документа заново
+         */
+        void rebuild();
+
+        /**
+         * @brief Посчитать слова и символы в блоке
+         */
+        static BlockCounters countBlock(const QTextBlock& _block);
+
+        /**
+         * @brief Учитывается ли блок в итоговых счётчиках
+         */
+        static bool isCounted(const BlockCounters& _block);
+
+    private:
+        /**
+         * @brief Документ, для которого строится индекс
+         */
+        QTextDocument* m_document = nullptr;
+
+        /**
+         * @brief Счётчики каждого из блоков документа, по номеру блока
+         */
+        QVector<BlockCounters> m_blocks;
+
+        /**
+         * @brief Итоговые счётчики
+         */
+        Counters m_total;
+    };
+}
+
+#endif // SCRIPTTEXTCOUNTERSINDEX_H
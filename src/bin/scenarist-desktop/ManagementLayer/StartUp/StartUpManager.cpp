@@ -31,6 +31,7 @@
 #include <3rd_party/Widgets/QLightBoxWidget/qlightboxmessage.h>
 
 #include <NetworkRequest.h>
+#include <NetworkRequestGroup.h>
 
 #include <QApplication>
 #include <QDesktopServices>
@@ -57,12 +58,19 @@ using UserInterface::UpdateDialog;
 
 namespace {
     QUrl UPDATE_URL = QString("https://kitscenarist.ru/api/app/updates/");
+    QUrl FEEDBACK_URL = QString("https://kitscenarist.ru/api/app/feedback/");
+
+    /**
+     * @brief Максимальное количество одновременно выполняемых запросов стартовой страницы
+     */
+    const int kMaximumConcurrentRequests = 4;
 }
 
 
 StartUpManager::StartUpManager(QObject *_parent, QWidget* _parentWidget) :
     QObject(_parent),
-    m_view(new StartUpView(_parentWidget))
+    m_view(new StartUpView(_parentWidget)),
+    m_networkRequests(new NetworkRequestGroup(kMaximumConcurrentRequests, this))
 {
     initConnections();
 }
@@ -107,20 +115,30 @@ void StartUpManager::checkCrashReports()
             dialog.setEmail(email);
         }
 
-        bool handled = true;
         if (dialog.exec() == CrashReportDialog::Accepted) {
-            dialog.showProgress();
+            //
+            // Отправляем отчёты параллельно, не блокируя запуск приложения.
+            // Прогресс отправки в диалоге не показываем, т.к. диалог закрывается сразу после
+            // постановки отчётов в очередь, а не по окончании их отправки.
+            // Отчёт помечается отправленным только после успешной загрузки, т.к. во время
+            // отправки файл ещё читается, а неотправленные отчёты нужно предложить отправить
+            // при следующем запуске
+            //
             for (const auto& reportPath : unhandledReportsPaths) {
-                //
-                // Отправляем
-                //
-                NetworkRequest loader;
-                loader.setRequestMethod(NetworkRequestMethod::Post);
-                loader.addRequestAttribute("version", QApplication::applicationVersion());
-                loader.addRequestAttribute("email", dialog.email());
-                loader.addRequestAttribute("message", dialog.message());
-                loader.addRequestAttributeFile("report", reportPath);
-                loader.loadSync("https://kitscenarist.ru/api/app/feedback/");
+                NetworkRequest* loader = new NetworkRequest;
+                loader->setRequestMethod(NetworkRequestMethod::Post);
+                loader->addRequestAttribute("version", QApplication::applicationVersion());
+                loader->addRequestAttribute("email", dialog.email());
+                loader->addRequestAttribute("message", dialog.message());
+                loader->addRequestAttributeFile("report", reportPath);
+                m_networkRequests->loadAsync(loader, FEEDBACK_URL,
+                    [reportPath, sendedSuffix] (const QByteArray&, const QString& _error) {
+                        if (!_error.isEmpty()) {
+                            return;
+                        }
+
+                        QFile::rename(reportPath, reportPath +  "." + sendedSuffix);
+                    });
             }
 
             //
@@ -133,22 +151,23 @@ void StartUpManager::checkCrashReports()
                             SettingsStorage::ApplicationSettings);
             }
         } else {
-            handled = false;
-        }
-
-        //
-        // Помечаем отчёты, чтобы в слдующий раз на них не обращать внимания
-        //
-        for (auto& reportPath : unhandledReportsPaths) {
-            QFile::rename(reportPath, reportPath +  "." + (handled ? sendedSuffix : ignoredSuffix));
+            //
+            // Помечаем отчёты, чтобы в слдующий раз на них не обращать внимания
+            //
+            for (auto& reportPath : unhandledReportsPaths) {
+                QFile::rename(reportPath, reportPath +  "." + ignoredSuffix);
+            }
         }
     }
 }
 
 void StartUpManager::checkNewVersion()
 {
-    NetworkRequest loader;
-    loader.setRequestMethod(NetworkRequestMethod::Post);
+    NetworkRequest* loader = new NetworkRequest;
+    loader->setRequestMethod(NetworkRequestMethod::Post);
+    //
+    // Кэш для проверки обновлений не используем, т.к. по этому запросу также ведётся учёт запусков
+    //
 
     //
     // Сформируем uuid для приложения, по которому будем идентифицировать данного пользователя
@@ -163,7 +182,7 @@ void StartUpManager::checkNewVersion()
     // Построим ссылку, чтобы учитывать запрос на проверку обновлений
     //
 
-    loader.addRequestAttribute("system_type",
+    loader->addRequestAttribute("system_type",
 #ifdef Q_OS_WIN
                 "windows"
 #elif defined Q_OS_LINUX
@@ -175,90 +194,13 @@ void StartUpManager::checkNewVersion()
 #endif
                 );
 
-    loader.addRequestAttribute("system_name", QSysInfo::prettyProductName().toUtf8().toPercentEncoding());
-    loader.addRequestAttribute("uuid", uuid);
-    loader.addRequestAttribute("application_version", QApplication::applicationVersion());
-
-    QByteArray response = loader.loadSync(UPDATE_URL);
-
-    if (!response.isEmpty()) {
-        QXmlStreamReader responseReader(response);
-
-        const int currentLang =
-                DataStorageLayer::StorageFacade::settingsStorage()->value(
-                    "application/language",
-                    DataStorageLayer::SettingsStorage::ApplicationSettings)
-                .toInt();
-        QString needLang;
-        if (currentLang == 0
-                || (currentLang == -1
-                    && QLocale().language() == QLocale::Russian)) {
-            needLang = "ru";
-        } else {
-            needLang = "en";
-        }
+    loader->addRequestAttribute("system_name", QSysInfo::prettyProductName().toUtf8().toPercentEncoding());
+    loader->addRequestAttribute("uuid", uuid);
+    loader->addRequestAttribute("application_version", QApplication::applicationVersion());
 
-        //
-        // Распарсим ответ. Нам нужна версия, ее описание, шаблон на скачивание и является ли бетой
-        //
-        int funded = 0;
-        while (!responseReader.atEnd()) {
-            responseReader.readNext();
-            if (responseReader.name().toString() == "update"
-                    && responseReader.tokenType() == QXmlStreamReader::StartElement) {
-                QXmlStreamAttributes attributes = responseReader.attributes();
-                m_updateVersion = attributes.value("version").toString();
-                m_updateFileTemplate = attributes.value("file_template").toString();
-                m_updateIsBeta = attributes.value("is_beta").toString() == "true"; // :)
-                if (attributes.hasAttribute("funded")) {
-                    funded = attributes.value("funded").toInt();
-                }
-                responseReader.readNext();
-            } else if (responseReader.name().toString() == "description"
-                    && responseReader.tokenType() == QXmlStreamReader::StartElement) {
-                QString lang = responseReader.attributes().value("language").toString();
-                if (lang == needLang) {
-                    //
-                    // Либо русская локаль и русский текст, либо нерусская локаль и нерусский текст
-                    //
-                    responseReader.readNext();
-                    responseReader.readNext();
-                    m_updateDescription = TextEditHelper::fromHtmlEscaped(responseReader.text().toString());
-                }
-                responseReader.readNext();
-            }
-        }
-
-        m_view->setCrowdfundingVisible(funded > 0, funded);
-
-        //
-        // Загрузим версию, либо которая установлена, либо которую пропустили
-        //
-        QString prevVersion =
-                    DataStorageLayer::StorageFacade::settingsStorage()->value(
-                        "application/latest_version",
-                        DataStorageLayer::SettingsStorage::ApplicationSettings);
-
-        if (m_updateVersion != QApplication::applicationVersion()
-            && m_updateVersion != prevVersion
-            && !QLightBoxWidget::hasOpenedWidgets()) {
-            //
-            // Есть новая версия, которая не совпадает с нашей. Покажем диалог
-            //
-            showUpdateDialogImpl();
-        }
-
-
-        if (QApplication::applicationVersion() != m_updateVersion) {
-            //
-            // Если оказались здесь, значит либо отменили установку, либо пропустили обновление.
-            // Будем показывать пользователю кнопку-ссылку на обновление
-            //
-            emit updatePublished(m_updateVersion);
-        }
-    } else {
-        m_view->setCrowdfundingVisible(true, 0);
-    }
+    m_networkRequests->loadAsync(loader, UPDATE_URL, [this] (const QByteArray& _response, const QString&) {
+        handleNewVersionInfo(_response);
+    });
 }
 
 bool StartUpManager::isOnLocalProjectsTab() const
@@ -403,35 +345,41 @@ QString StartUpManager::makeUpdateUrl(const QString& _fileTemplate)
 
 void StartUpManager::downloadUpdate(const QString& _fileTemplate)
 {
-    NetworkRequest loader;
-
-    connect(&loader, &NetworkRequest::downloadProgress, this, &StartUpManager::downloadProgressForUpdate);
-    connect(this, &StartUpManager::stopDownloadForUpdate, &loader, &NetworkRequest::stop);
+    //
+    // Прерываем предыдущую загрузку, если она ещё выполняется
+    //
+    m_updateDownloadToken.cancel();
+    m_updateDownloadToken = NetworkCancellationToken();
 
-    loader.setRequestMethod(NetworkRequestMethod::Post);
-    loader.clearRequestAttributes();
+    NetworkRequest* loader = new NetworkRequest;
+    connect(loader, &NetworkRequest::downloadProgress, this, &StartUpManager::downloadProgressForUpdate);
+    loader->setRequestMethod(NetworkRequestMethod::Post);
+    loader->clearRequestAttributes();
 
     //
     // Загружаем установщик
     //
     const QUrl updateInfoUrl(makeUpdateUrl(_fileTemplate));
-    QByteArray response = loader.loadSync(updateInfoUrl);
-    if (response.isEmpty()) {
-        emit errorDownloadForUpdate(updateInfoUrl.toString());
-        return;
-    }
+    m_networkRequests->loadAsync(loader, updateInfoUrl,
+        [this, updateInfoUrl] (const QByteArray& _response, const QString&) {
+            if (_response.isEmpty()) {
+                emit errorDownloadForUpdate(updateInfoUrl.toString());
+                return;
+            }
 
-    //
-    // Сохраняем установщик в файл
-    //
-    const QString tempDirPath = QDir::toNativeSeparators(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
-    m_updateFile = tempDirPath + QDir::separator() + updateInfoUrl.fileName();
-    QFile tempFile(m_updateFile);
-    if (tempFile.open(QIODevice::WriteOnly)) {
-        tempFile.write(response);
-        tempFile.close();
-        emit downloadFinishedForUpdate();
-    }
+            //
+            // Сохраняем установщик в файл
+            //
+            const QString tempDirPath = QDir::toNativeSeparators(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+            m_updateFile = tempDirPath + QDir::separator() + updateInfoUrl.fileName();
+            QFile tempFile(m_updateFile);
+            if (tempFile.open(QIODevice::WriteOnly)) {
+                tempFile.write(_response);
+                tempFile.close();
+                emit downloadFinishedForUpdate();
+            }
+        },
+        m_updateDownloadToken);
 }
 
 void StartUpManager::initConnections()
@@ -451,4 +399,88 @@ void StartUpManager::initConnections()
     connect(m_view, &StartUpView::shareRemoteProjectRequested, this, &StartUpManager::shareRemoteProjectRequested);
     connect(m_view, &StartUpView::unshareRemoteProjectRequested, this, &StartUpManager::unshareRemoteProjectRequested);
     connect(m_view, &StartUpView::refreshProjects, this, &StartUpManager::refreshProjectsRequested);
+
+    connect(this, &StartUpManager::stopDownloadForUpdate, this, [this] { m_updateDownloadToken.cancel(); });
+}
+
+void StartUpManager::handleNewVersionInfo(const QByteArray& _response)
+{
+    if (!_response.isEmpty()) {
+        QXmlStreamReader responseReader(_response);
+
+        const int currentLang =
+                DataStorageLayer::StorageFacade::settingsStorage()->value(
+                    "application/language",
+                    DataStorageLayer::SettingsStorage::ApplicationSettings)
+                .toInt();
+        QString needLang;
+        if (currentLang == 0
+                || (currentLang == -1
+                    && QLocale().language() == QLocale::Russian)) {
+            needLang = "ru";
+        } else {
+            needLang = "en";
+        }
+
+        //
+        // Распарсим ответ. Нам нужна версия, ее описание, шаблон на скачивание и является ли бетой
+        //
+        int funded = 0;
+        while (!responseReader.atEnd()) {
+            responseReader.readNext();
+            if (responseReader.name().toString() == "update"
+                    && responseReader.tokenType() == QXmlStreamReader::StartElement) {
+                QXmlStreamAttributes attributes = responseReader.attributes();
+                m_updateVersion = attributes.value("version").toString();
+                m_updateFileTemplate = attributes.value("file_template").toString();
+                m_updateIsBeta = attributes.value("is_beta").toString() == "true"; // :)
+                if (attributes.hasAttribute("funded")) {
+                    funded = attributes.value("funded").toInt();
+                }
+                responseReader.readNext();
+            } else if (responseReader.name().toString() == "description"
+                    && responseReader.tokenType() == QXmlStreamReader::StartElement) {
+                QString lang = responseReader.attributes().value("language").toString();
+                if (lang == needLang) {
+                    //
+                    // Либо русская локаль и русский текст, либо нерусская локаль и нерусский текст
+                    //
+                    responseReader.readNext();
+                    responseReader.readNext();
+                    m_updateDescription = TextEditHelper::fromHtmlEscaped(responseReader.text().toString());
+                }
+                responseReader.readNext();
+            }
+        }
+
+        m_view->setCrowdfundingVisible(funded > 0, funded);
+
+        //
+        // Загрузим версию, либо которая установлена, либо которую пропустили
+        //
+        QString prevVersion =
+                    DataStorageLayer::StorageFacade::settingsStorage()->value(
+                        "application/latest_version",
+                        DataStorageLayer::SettingsStorage::ApplicationSettings);
+
+        if (m_updateVersion != QApplication::applicationVersion()
+            && m_updateVersion != prevVersion
+            && !QLightBoxWidget::hasOpenedWidgets()) {
+            //
+            // Есть новая версия, которая не совпадает с нашей. Покажем диалог
+            //
+            showUpdateDialogImpl();
+        }
+
+
+        if (QApplication::applicationVersion() != m_updateVersion) {
+            //
+            // Если оказались здесь, значит либо отменили установку, либо пропустили обновление.
+            // Будем показывать пользователю кнопку-ссылку на обновление
+            //
+            emit updatePublished(m_updateVersion);
+        }
+    } else {
+        m_view->setCrowdfundingVisible(true, 0);
+    }
 }
@@ -22,10 +22,13 @@
 
 #include <QMap>
 
+#include <NetworkCancellationToken.h>
+
 namespace UserInterface {
     class StartUpView;
 }
 
+class NetworkRequestGroup;
 class QAbstractItemModel;
 class QMenu;
 
@@ -209,12 +212,27 @@ namespace ManagementLayer
          */
         void initConnections();
 
+        /**
+         * @brief Обработать информацию о новой версии, полученную с сервера
+         */
+        void handleNewVersionInfo(const QByteArray& _response);
+
     private:
         /**
          * @brief Представление для стартовой страницы
          */
         UserInterface::StartUpView* m_view;
 
+        /**
+         * @brief Асинхронные сетевые запросы стартовой страницы
+         */
+        NetworkRequestGroup* m_networkRequests;
+
+        /**
+         * @brief Токен отмены загрузки файла обновления
+         */
+        NetworkCancellationToken m_updateDownloadToken;
+
         /**
          * @brief Путь до файла с обновлениями
          */
@@ -1,5 +1,7 @@
 #include "StatisticsManager.h"
 
+#include <ManagementLayer/Tracing/Tracer.h>
+
 #include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
 #include <BusinessLayer/Statistics/StatisticsFacade.h>
 #include <BusinessLayer/Statistics/Reports/AbstractReport.h>
@@ -37,6 +39,8 @@ QWidget* StatisticsManager::view() const
 
 void StatisticsManager::loadCurrentProject()
 {
+    const Tracer::Span span("StatisticsManager::loadCurrentProject");
+
     //
     // Очистим от старых данных
     //
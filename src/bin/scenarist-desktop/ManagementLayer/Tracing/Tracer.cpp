@@ -0,0 +1,184 @@
+#include "Tracer.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+using ManagementLayer::Tracer;
+
+namespace {
+    /**
+     * @brief Переменная окружения с путём к файлу трассировки
+     */
+    const char* kTraceFileVariable = "KIT_TRACE_FILE";
+
+    /**
+     * @brief Количество замеров, которые хранятся в буфере
+     */
+    const int kBufferCapacity = 4096;
+
+    /**
+     * @brief Завершённый замер
+     */
+    struct Event {
+        const char* name = nullptr;
+        qint64 startNs = 0;
+        qint64 durationNs = 0;
+        quint64 threadId = 0;
+    };
+
+    /**
+     * @brief Кольцевой буфер замеров
+     */
+    class TraceBuffer
+    {
+    public:
+        TraceBuffer() :
+            filePath(QString::fromLocal8Bit(qgetenv(kTraceFileVariable)))
+        {
+            if (!filePath.isEmpty()) {
+                events.resize(kBufferCapacity);
+                clock.start();
+            }
+        }
+
+        /**
+         * @brief Путь к файлу трассировки, если пуст, то трассировка выключена
+         */
+        const QString filePath;
+
+        /**
+         * @brief Часы трассировки
+         */
+        QElapsedTimer clock;
+
+        /**
+         * @brief Защита буфера от одновременной записи из разных потоков
+         */
+        QMutex mutex;
+
+        /**
+         * @brief Замеры
+         */
+        QVector<Event> events;
+
+        /**
+         * @brief Позиция, в которую будет записан следующий замер
+         */
+        int next = 0;
+
+        /**
+         * @brief Был ли буфер заполнен хотя бы раз
+         */
+        bool isWrapped = false;
+    };
+
+    static TraceBuffer& traceBuffer() {
+        static TraceBuffer s_buffer;
+        return s_buffer;
+    }
+}
+
+
+Tracer::Span::Span(const char* _name) :
+    m_name(_name)
+{
+    if (Tracer::isEnabled()) {
+        m_startNs = Tracer::nowNs();
+    }
+}
+
+Tracer::Span::~Span()
+{
+    if (m_startNs >= 0) {
+        Tracer::record(m_name, m_startNs, Tracer::nowNs() - m_startNs);
+    }
+}
+
+bool Tracer::isEnabled()
+{
+    return !traceBuffer().filePath.isEmpty();
+}
+
+void Tracer::record(const char* _name, qint64 _startNs, qint64 _durationNs)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    Event event;
+    event.name = _name;
+    event.startNs = _startNs;
+    event.durationNs = _durationNs;
+    event.threadId = static_cast<quint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    buffer.events[buffer.next] = event;
+    ++buffer.next;
+    if (buffer.next == buffer.events.size()) {
+        buffer.next = 0;
+        buffer.isWrapped = true;
+    }
+}
+
+qint64 Tracer::nowNs()
+{
+    return isEnabled() ? traceBuffer().clock.nsecsElapsed() : 0;
+}
+
+bool Tracer::exportChromeTrace(const QString& _filePath)
+{
+    TraceBuffer& buffer = traceBuffer();
+    const QString filePath = _filePath.isEmpty() ? buffer.filePath : _filePath;
+    if (!isEnabled() || filePath.isEmpty()) {
+        return false;
+    }
+
+    //
+    // Копируем замеры, чтобы не держать блокировку во время формирования файла
+    //
+    QVector<Event> events;
+    {
+        QMutexLocker locker(&buffer.mutex);
+        if (buffer.isWrapped) {
+            events = buffer.events.mid(buffer.next) + buffer.events.mid(0, buffer.next);
+        } else {
+            events = buffer.events.mid(0, buffer.next);
+        }
+    }
+
+    //
+    // Формат Chrome trace-event: завершённые события ("ph": "X") с временем начала
+    // и длительностью в микросекундах
+    //
+    const qint64 processId = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    for (const Event& event : events) {
+        QJsonObject traceEvent;
+        traceEvent["name"] = QString::fromLatin1(event.name);
+        traceEvent["cat"] = QStringLiteral("project");
+        traceEvent["ph"] = QStringLiteral("X");
+        traceEvent["ts"] = event.startNs / 1000.;
+        traceEvent["dur"] = event.durationNs / 1000.;
+        traceEvent["pid"] = processId;
+        traceEvent["tid"] = static_cast<qint64>(event.threadId);
+        traceEvents.append(traceEvent);
+    }
+    QJsonObject trace;
+    trace["traceEvents"] = traceEvents;
+    trace["displayTimeUnit"] = QStringLiteral("ms");
+
+    QFile traceFile(filePath);
+    if (!traceFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return traceFile.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) != -1;
+}
@@ -0,0 +1,69 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QtGlobal>
+
+class QString;
+
+
+namespace ManagementLayer
+{
+    /**
+     * @brief Трассировка этапов работы с проектом
+     * @note Замеры пишутся в кольцевой буфер фиксированного размера, поэтому при долгой работе
+     *       сохраняются только последние события. Трассировка включается переменной окружения
+     *       KIT_TRACE_FILE, в файл из которой при выходе из программы выгружаются замеры
+     *       в формате Chrome trace-event (открывается в chrome://tracing и Perfetto)
+     */
+    class Tracer
+    {
+    public:
+        /**
+         * @brief Замер длительности области видимости
+         * @note Название должно жить всё время работы программы, обычно это строковый литерал
+         */
+        class Span
+        {
+        public:
+            explicit Span(const char* _name);
+            ~Span();
+
+        private:
+            Q_DISABLE_COPY(Span)
+
+            /**
+             * @brief Название замера
+             */
+            const char* m_name = nullptr;
+
+            /**
+             * @brief Время начала замера в наносекундах, либо -1, если трассировка выключена
+             */
+            qint64 m_startNs = -1;
+        };
+
+    public:
+        /**
+         * @brief Включена ли трассировка
+         */
+        static bool isEnabled();
+
+        /**
+         * @brief Сохранить завершённый замер
+         */
+        static void record(const char* _name, qint64 _startNs, qint64 _durationNs);
+
+        /**
+         * @brief Текущее время трассировки в наносекундах
+         */
+        static qint64 nowNs();
+
+        /**
+         * @brief Выгрузить накопленные замеры в файл в формате Chrome trace-event
+         * @param _filePath - путь к файлу, если не задан, используется путь из KIT_TRACE_FILE
+         */
+        static bool exportChromeTrace(const QString& _filePath);
+    };
+}
+
+#endif // TRACER_H
@@ -179,6 +179,7 @@ void ScenarioFastFormatWidget::aboutChangeStyle()
         ScenarioBlockStyle::Type type =
                 (ScenarioBlockStyle::Type)button->property(STYLE_PROPERTY_KEY).toInt();
         if (m_editor != 0) {
+            emit styleAboutToBeChanged();
             m_editor->changeScenarioBlockTypeForSelection(type);
         }
     }
@@ -38,6 +38,11 @@ namespace UserInterface
          */
         void focusMovedToEditor();
 
+        /**
+         * @brief Стиль блока будет изменён
+         */
+        void styleAboutToBeChanged();
+
     private slots:
         /**
          * @brief Перейти к следующему блоку
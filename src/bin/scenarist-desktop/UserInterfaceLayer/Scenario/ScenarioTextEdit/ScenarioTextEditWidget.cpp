@@ -27,6 +27,7 @@
 #include <QCryptographicHash>
 #include <QHeaderView>
 #include <QHBoxLayout>
+#include <QKeyEvent>
 #include <QLabel>
 #include <QMenu>
 #include <QScrollBar>
@@ -231,6 +232,14 @@ void ScenarioTextEditWidget::setTextEditZoomRange(qreal _zoomRange)
     m_editorWrapper->setZoomRange(_zoomRange);
 }
 
+QPair<int, int> ScenarioTextEditWidget::visibleTextRange() const
+{
+    const QRect viewportRect = m_editor->viewport()->rect();
+    const int from = m_editor->cursorForPosition(viewportRect.topLeft()).position();
+    const int to = m_editor->cursorForPosition(viewportRect.bottomRight()).position();
+    return qMakePair(from, to);
+}
+
 int ScenarioTextEditWidget::cursorPosition() const
 {
     return m_editor->textCursor().position();
@@ -655,6 +664,58 @@ void ScenarioTextEditWidget::setZenMode(bool _isZen)
     }
 }
 
+bool ScenarioTextEditWidget::eventFilter(QObject* _watched, QEvent* _event)
+{
+    if (_watched == m_editor
+        || _watched == m_editor->viewport()) {
+        switch (_event->type()) {
+            case QEvent::KeyPress: {
+                //
+                // Клавиши перемещения не вводят текст, на них не реагируем
+                //
+                if (!static_cast<QKeyEvent*>(_event)->text().isEmpty()) {
+                    emit textAboutToBeEdited();
+                }
+                break;
+            }
+
+            case QEvent::ShortcutOverride: {
+                //
+                // Сочетаниями клавиш меняют стили блоков, вставляют и вырезают текст
+                //
+                const Qt::KeyboardModifiers modifiers = static_cast<QKeyEvent*>(_event)->modifiers();
+                if (modifiers.testFlag(Qt::ControlModifier)
+                    || modifiers.testFlag(Qt::AltModifier)
+                    || modifiers.testFlag(Qt::MetaModifier)) {
+                    emit textAboutToBeEdited();
+                }
+                break;
+            }
+
+            case QEvent::InputMethod:
+            case QEvent::Drop:
+            case QEvent::ContextMenu: {
+                emit textAboutToBeEdited();
+                break;
+            }
+
+            default: {
+                break;
+            }
+        }
+    }
+    //
+    // Поиск с заменой и рецензирование меняют текст в обход редактора, поэтому любое
+    // обращение к их панелям считаем началом правки
+    //
+    else if (_event->type() == QEvent::MouseButtonPress
+             || _event->type() == QEvent::KeyPress) {
+        emit textAboutToBeEdited();
+    }
+
+    return QWidget::eventFilter(_watched, _event);
+}
+
 void ScenarioTextEditWidget::updateTextMode(bool _outlineMode)
 {
     m_editor->setOutlineMode(_outlineMode);
@@ -709,6 +770,7 @@ void ScenarioTextEditWidget::aboutChangeTextStyle()
     //
     // Меняем стиль блока, если это возможно
     //
+    emit textAboutToBeEdited();
     m_editor->changeScenarioBlockTypeForSelection(type);
     m_editorWrapper->setFocus();
 }
@@ -771,9 +833,17 @@ void ScenarioTextEditWidget::initView()
     m_editor->setObjectName("scenarioEditor");
     m_editor->setPageFormat(ScenarioTemplateFacade::getTemplate().pageSizeId());
     m_editor->setShortcutsContextWidget(m_editorWrapper);
+    m_editor->installEventFilter(this);
+    m_editor->viewport()->installEventFilter(this);
 
     m_searchLine->setEditor(m_editor);
     m_searchLine->hide();
+    for (QWidget* panel : QList<QWidget*>({ m_searchLine, m_review, m_reviewView })) {
+        panel->installEventFilter(this);
+        for (QWidget* panelChild : panel->findChildren<QWidget*>()) {
+            panelChild->installEventFilter(this);
+        }
+    }
 
     m_fastFormatWidget->setEditor(m_editor);
     m_fastFormatWidget->hide();
@@ -882,6 +952,8 @@ void ScenarioTextEditWidget::initConnections()
     connect(m_fastFormat, &FlatButton::toggled, this, &ScenarioTextEditWidget::aboutShowFastFormat);
     connect(m_fastFormatWidget, &UserInterface::ScenarioFastFormatWidget::focusMovedToEditor,
             [=] { m_editorWrapper->setFocus(); });
+    connect(m_fastFormatWidget, &UserInterface::ScenarioFastFormatWidget::styleAboutToBeChanged,
+            this, &ScenarioTextEditWidget::textAboutToBeEdited);
     connect(m_review, &ScenarioReviewPanel::toggled, m_reviewView, &ScenarioReviewView::setVisible);
     connect(m_reviewView, &ScenarioReviewView::undoRequest, this, &ScenarioTextEditWidget::undoRequest);
     connect(m_reviewView, &ScenarioReviewView::redoRequest, this, &ScenarioTextEditWidget::redoRequest);
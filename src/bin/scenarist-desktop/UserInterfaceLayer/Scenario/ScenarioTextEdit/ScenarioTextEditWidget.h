@@ -2,6 +2,7 @@
 #define SCENARIOTEXTEDITWIDGET_H
 
 #include <QFrame>
+#include <QPair>
 
 class FlatButton;
 class QComboBox;
@@ -135,6 +136,11 @@ namespace UserInterface
          */
         void setTextEditZoomRange(qreal _zoomRange);
 
+        /**
+         * @brief Получить диапазон позиций текста, видимого в редакторе
+         */
+        QPair<int, int> visibleTextRange() const;
+
         /**
          * @brief Получить текущую позицию курсора
          */
@@ -275,6 +281,21 @@ namespace UserInterface
          */
         void renameSceneNumberRequested(const QString& _newName, int _position);
 
+        /**
+         * @brief Пользователь собирается изменить текст
+         * @note Испускается до того, как изменение попадёт в документ: при вводе с клавиатуры,
+         *       сочетаниях клавиш, перетаскивании, открытии контекстного меню, из которого можно
+         *       вставить, вырезать текст, или исправить опечатку, работе с поиском и заменой,
+         *       с панелями рецензирования и быстрого форматирования
+         */
+        void textAboutToBeEdited();
+
+    protected:
+        /**
+         * @brief Переопределяется, чтобы уведомлять о правке текста в редакторе и панелях до её обработки
+         */
+        bool eventFilter(QObject* _watched, QEvent* _event) override;
+
     private slots:
         /**
          * @brief Обновить текущий режим (поэпизодник или текст)
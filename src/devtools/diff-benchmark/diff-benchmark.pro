@@ -0,0 +1,20 @@
+QT += core
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += \
+    ../../bin/scenarist-core \
+    ../../libs/blockdiff
+
+SOURCES += \
+    ../../bin/scenarist-core/3rd_party/Helpers/DiffMatchPatch.cpp \
+    ../../libs/blockdiff/blockdiffengine.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../bin/scenarist-core/3rd_party/Helpers/DiffMatchPatch.h \
+    ../../libs/blockdiff/blockdiffengine.h
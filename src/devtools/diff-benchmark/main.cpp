@@ -0,0 +1,95 @@
+#include <blockdiffengine.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace {
+    /**
+     * @brief Прочитать текст файла
+     */
+    static QString readFile(const QString& _path, bool& _ok) {
+        QFile file(_path);
+        _ok = file.open(QIODevice::ReadOnly);
+        return _ok ? QString::fromUtf8(file.readAll()) : QString();
+    }
+
+    /**
+     * @brief Замерить среднее время построения патча, мс
+     */
+    template <typename MakePatch>
+    static double measure(int _iterations, MakePatch _makePatch, QString& _patch) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int iteration = 0; iteration < _iterations; ++iteration) {
+            _patch = _makePatch();
+        }
+        return timer.nsecsElapsed() / 1000000.0 / _iterations;
+    }
+}
+
+
+/**
+ * @brief Сравнение скорости построения патчей diff_match_patch и BlockDiffEngine
+ *
+ * Использование: diff-benchmark [-n iterations] old.xml new.xml [old.xml new.xml ...]
+ * В качестве пар файлов удобно брать xml соседних версий сценария из одного проекта
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+
+    QStringList arguments = a.arguments().mid(1);
+    int iterations = 10;
+    if (arguments.size() >= 2 && arguments.first() == "-n") {
+        iterations = std::max(arguments.at(1).toInt(), 1);
+        arguments = arguments.mid(2);
+    }
+    if (arguments.isEmpty() || arguments.size() % 2 != 0) {
+        out << "Usage: diff-benchmark [-n iterations] old.xml new.xml [old.xml new.xml ...]" << endl;
+        return 1;
+    }
+
+    bool allPatchesValid = true;
+    for (int index = 0; index < arguments.size(); index += 2) {
+        bool isOldRead = false;
+        bool isNewRead = false;
+        const QString oldText = readFile(arguments.at(index), isOldRead);
+        const QString newText = readFile(arguments.at(index + 1), isNewRead);
+        if (!isOldRead || !isNewRead) {
+            out << "Can't read " << arguments.at(isOldRead ? index + 1 : index) << endl;
+            return 1;
+        }
+
+        diff_match_patch dmp;
+        QString dmpPatch;
+        const double dmpTime = measure(iterations, [&dmp, &oldText, &newText] {
+            return dmp.patch_toText(dmp.patch_make(oldText, newText));
+        }, dmpPatch);
+        QString blockPatch;
+        const double blockTime = measure(iterations, [&oldText, &newText] {
+            return BlockDiffEngine::makePatch(oldText, newText);
+        }, blockPatch);
+
+        //
+        // Патч нового движка должен накладываться так же, как и обычный
+        //
+        QList<Patch> patches = dmp.patch_fromText(blockPatch);
+        const bool isPatchValid = dmp.patch_apply(patches, oldText).first == newText;
+        allPatchesValid = allPatchesValid && isPatchValid;
+
+        out << arguments.at(index) << " -> " << arguments.at(index + 1) << endl
+            << "    size: " << oldText.length() << " -> " << newText.length() << " chars" << endl
+            << "    diff_match_patch: " << dmpTime << " ms, patch " << dmpPatch.length() << " chars" << endl
+            << "    BlockDiffEngine:  " << blockTime << " ms, patch " << blockPatch.length() << " chars"
+            << (isPatchValid ? "" : ", PATCH IS NOT VALID") << endl
+            << "    speedup: " << (blockTime > 0 ? dmpTime / blockTime : 0) << "x" << endl;
+    }
+
+    return allPatchesValid ? 0 : 2;
+}
@@ -0,0 +1,37 @@
+#-------------------------------------------------
+#
+# Движок сравнения текстов с выравниванием по блокам
+#
+# Формирует тот же список различий, что и diff_match_patch, реализация которого
+# собирается вместе с программой, поэтому здесь подключается только её заголовок
+#
+#-------------------------------------------------
+
+QT       -= gui
+
+TARGET = blockdiff
+TEMPLATE = lib
+CONFIG += staticlib c++11
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../../build/Debug/libs/blockdiff
+} else {
+    DESTDIR = $$PWD/../../../build/Release/libs/blockdiff
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+INCLUDEPATH += $$PWD/../../bin/scenarist-core
+
+SOURCES += \
+    blockdiffengine.cpp
+
+HEADERS += \
+    blockdiffengine.h
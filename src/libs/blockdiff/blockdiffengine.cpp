@@ -0,0 +1,227 @@
+#include "blockdiffengine.h"
+
+#include <QHash>
+#include <QVector>
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCK_DIFF_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+    /**
+     * @brief Максимальное количество различных блоков, которые можно закодировать символами
+     * @note Символы из диапазона суррогатных пар не используются
+     */
+    const int MAXIMUM_BLOCKS_COUNT = 0xD7FF;
+
+    /**
+     * @brief Является ли символ концом блока
+     */
+    static bool isBlockEnd(const QChar& _character) {
+        return _character == '>' || _character == '\n';
+    }
+
+    /**
+     * @brief Закодировать текст, заменив каждый блок одним символом
+     * @return false, если различных блоков слишком много для кодирования
+     */
+    static bool blocksToChars(const QString& _text, QHash<QString, int>& _blocksCodes,
+        QVector<QString>& _blocks, QString& _encodedText) {
+        _encodedText.reserve(_text.length() / 16);
+
+        int blockStart = 0;
+        while (blockStart < _text.length()) {
+            int blockEnd = blockStart;
+            while (blockEnd < _text.length() && !isBlockEnd(_text.at(blockEnd))) {
+                ++blockEnd;
+            }
+            if (blockEnd < _text.length()) {
+                ++blockEnd;
+            }
+
+            const QString block = _text.mid(blockStart, blockEnd - blockStart);
+            int code = _blocksCodes.value(block, 0);
+            if (code == 0) {
+                if (_blocks.size() >= MAXIMUM_BLOCKS_COUNT) {
+                    return false;
+                }
+
+                _blocks.append(block);
+                code = _blocks.size();
+                _blocksCodes.insert(block, code);
+            }
+            _encodedText.append(QChar(static_cast<ushort>(code)));
+
+            blockStart = blockEnd;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Раскодировать текст, заменив символы блоками
+     */
+    static QString charsToBlocks(const QString& _encodedText, const QVector<QString>& _blocks) {
+        QString text;
+        for (const QChar& code : _encodedText) {
+            text.append(_blocks.at(code.unicode() - 1));
+        }
+        return text;
+    }
+}
+
+
+QList<Diff> BlockDiffEngine::diff(const QString& _text1, const QString& _text2)
+{
+    QList<Diff> diffs;
+    if (_text1 == _text2) {
+        if (!_text1.isEmpty()) {
+            diffs.append(Diff(EQUAL, _text1));
+        }
+        return diffs;
+    }
+
+    //
+    // Отбрасываем общие начало и конец текстов
+    //
+    const int prefixLength = commonPrefix(_text1.constData(), _text2.constData(),
+                                          std::min(_text1.length(), _text2.length()));
+    const int suffixLength = commonSuffix(_text1.constData() + _text1.length(), _text2.constData() + _text2.length(),
+                                          std::min(_text1.length(), _text2.length()) - prefixLength);
+    const QString middle1 = _text1.mid(prefixLength, _text1.length() - prefixLength - suffixLength);
+    const QString middle2 = _text2.mid(prefixLength, _text2.length() - prefixLength - suffixLength);
+
+    if (prefixLength > 0) {
+        diffs.append(Diff(EQUAL, _text1.left(prefixLength)));
+    }
+    if (middle1.isEmpty()) {
+        diffs.append(Diff(INSERT, middle2));
+    } else if (middle2.isEmpty()) {
+        diffs.append(Diff(DELETE, middle1));
+    } else {
+        diffBlocks(middle1, middle2, diffs);
+    }
+    if (suffixLength > 0) {
+        diffs.append(Diff(EQUAL, _text1.right(suffixLength)));
+    }
+
+    diff_match_patch dmp;
+    dmp.diff_cleanupMerge(diffs);
+    return diffs;
+}
+
+QString BlockDiffEngine::makePatch(const QString& _text1, const QString& _text2)
+{
+    diff_match_patch dmp;
+    return dmp.patch_toText(dmp.patch_make(_text1, diff(_text1, _text2)));
+}
+
+int BlockDiffEngine::commonPrefix(const QChar* _text1, const QChar* _text2, int _length)
+{
+    const ushort* text1 = reinterpret_cast<const ushort*>(_text1);
+    const ushort* text2 = reinterpret_cast<const ushort*>(_text2);
+    int position = 0;
+
+#ifdef BLOCK_DIFF_USE_SSE2
+    for (; position + 8 <= _length; position += 8) {
+        const __m128i chunk1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text1 + position));
+        const __m128i chunk2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text2 + position));
+        const uint mismatch = ~static_cast<uint>(_mm_movemask_epi8(_mm_cmpeq_epi16(chunk1, chunk2))) & 0xFFFF;
+        if (mismatch != 0) {
+            return position + static_cast<int>(qCountTrailingZeroBits(mismatch)) / 2;
+        }
+    }
+#endif
+
+    while (position < _length && text1[position] == text2[position]) {
+        ++position;
+    }
+    return position;
+}
+
+int BlockDiffEngine::commonSuffix(const QChar* _text1End, const QChar* _text2End, int _length)
+{
+    const ushort* text1End = reinterpret_cast<const ushort*>(_text1End);
+    const ushort* text2End = reinterpret_cast<const ushort*>(_text2End);
+    int length = 0;
+
+#ifdef BLOCK_DIFF_USE_SSE2
+    for (; length + 8 <= _length; length += 8) {
+        const __m128i chunk1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text1End - length - 8));
+        const __m128i chunk2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text2End - length - 8));
+        const uint mismatch = ~static_cast<uint>(_mm_movemask_epi8(_mm_cmpeq_epi16(chunk1, chunk2))) & 0xFFFF;
+        if (mismatch != 0) {
+            //
+            // Нужен последний из несовпавших символов, старший установленный бит
+            //
+            const int lastMismatch = (31 - static_cast<int>(qCountLeadingZeroBits(mismatch))) / 2;
+            return length + 7 - lastMismatch;
+        }
+    }
+#endif
+
+    while (length < _length && text1End[-length - 1] == text2End[-length - 1]) {
+        ++length;
+    }
+    return length;
+}
+
+void BlockDiffEngine::diffBlocks(const QString& _text1, const QString& _text2, QList<Diff>& _diffs)
+{
+    diff_match_patch dmp;
+
+    //
+    // Кодируем блоки символами и сравниваем закодированные тексты, они короче исходных в десятки раз
+    //
+    QHash<QString, int> blocksCodes;
+    QVector<QString> blocks;
+    QString encodedText1;
+    QString encodedText2;
+    if (!blocksToChars(_text1, blocksCodes, blocks, encodedText1)
+        || !blocksToChars(_text2, blocksCodes, blocks, encodedText2)) {
+        _diffs.append(dmp.diff_main(_text1, _text2, false));
+        return;
+    }
+    const QList<Diff> blocksDiffs = dmp.diff_main(encodedText1, encodedText2, false);
+
+    //
+    // Посимвольно сравниваем только те участки, где блоки различаются
+    //
+    QString deletedText;
+    QString insertedText;
+    auto flushChanges = [&dmp, &_diffs, &deletedText, &insertedText] {
+        if (!deletedText.isEmpty() && !insertedText.isEmpty()) {
+            _diffs.append(dmp.diff_main(deletedText, insertedText, false));
+        } else if (!deletedText.isEmpty()) {
+            _diffs.append(Diff(DELETE, deletedText));
+        } else if (!insertedText.isEmpty()) {
+            _diffs.append(Diff(INSERT, insertedText));
+        }
+        deletedText.clear();
+        insertedText.clear();
+    };
+    for (const Diff& blocksDiff : blocksDiffs) {
+        const QString text = charsToBlocks(blocksDiff.text, blocks);
+        switch (blocksDiff.operation) {
+            case DELETE: {
+                deletedText.append(text);
+                break;
+            }
+
+            case INSERT: {
+                insertedText.append(text);
+                break;
+            }
+
+            case EQUAL: {
+                flushChanges();
+                _diffs.append(Diff(EQUAL, text));
+                break;
+            }
+        }
+    }
+    flushChanges();
+}
@@ -0,0 +1,49 @@
+#ifndef BLOCKDIFFENGINE_H
+#define BLOCKDIFFENGINE_H
+
+#include <3rd_party/Helpers/DiffMatchPatch.h>
+
+#include <QList>
+#include <QString>
+
+
+/**
+ * @brief Движок сравнения текстов, выравнивающий их по блокам перед посимвольным сравнением
+ *
+ * Общие начало и конец текстов отбрасываются сравнением по 8 символов за раз, оставшаяся часть
+ * разбивается на блоки по концам xml-тегов и строк, блоки сравниваются по хэшам,
+ * а посимвольно сравниваются только участки, в которых блоки различаются.
+ * Результат - обычный список различий diff_match_patch, поэтому патчи из него строятся
+ * через patch_make и накладываются так же, как и патчи построенные по diff_main
+ */
+class BlockDiffEngine
+{
+public:
+    /**
+     * @brief Сформировать список различий между текстами
+     */
+    static QList<Diff> diff(const QString& _text1, const QString& _text2);
+
+    /**
+     * @brief Сформировать текстовый патч для перехода от первого текста ко второму
+     */
+    static QString makePatch(const QString& _text1, const QString& _text2);
+
+    /**
+     * @brief Длина общего начала двух строк
+     */
+    static int commonPrefix(const QChar* _text1, const QChar* _text2, int _length);
+
+    /**
+     * @brief Длина общего окончания двух строк, переданы указатели на их концы
+     */
+    static int commonSuffix(const QChar* _text1End, const QChar* _text2End, int _length);
+
+private:
+    /**
+     * @brief Сравнить тексты, выровняв их по блокам
+     */
+    static void diffBlocks(const QString& _text1, const QString& _text2, QList<Diff>& _diffs);
+};
+
+#endif // BLOCKDIFFENGINE_H
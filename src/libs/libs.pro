@@ -15,6 +15,7 @@ SUBDIRS = \
     fileformats \
     webloader \
     mythes \
-    qgumboparser
+    qgumboparser \
+    blockdiff
 
 win32: SUBDIRS += qBreakpad
@@ -0,0 +1,88 @@
+#include <cstdlib>
+#include "qgumboarena.h"
+#include "helper.h"
+
+namespace {
+
+const std::size_t MIN_BLOCK_SIZE = 64 * 1024;
+const std::size_t MAX_BLOCK_SIZE = 16 * 1024 * 1024;
+const std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+std::size_t alignedSize(std::size_t size)
+{
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+std::size_t initialSize(std::size_t size)
+{
+    //
+    // Big pages still start from a capped block and grow from there, instead of one huge malloc up front
+    //
+    if (size < MIN_BLOCK_SIZE)
+        return MIN_BLOCK_SIZE;
+    if (size > MAX_BLOCK_SIZE)
+        return MAX_BLOCK_SIZE;
+    return alignedSize(size);
+}
+
+} /* namespace */
+
+QGumboArena::QGumboArena(std::size_t initialBlockSize) :
+    nextBlockSize_(initialSize(initialBlockSize))
+{
+}
+
+QGumboArena::~QGumboArena()
+{
+    for (char* block : blocks_)
+        std::free(block);
+}
+
+void* QGumboArena::allocate(std::size_t size)
+{
+    //
+    // malloc semantics: zero-sized requests still get a unique pointer
+    //
+    size = alignedSize(size ? size : 1);
+    if (size > left_ && !addBlock(size))
+        return nullptr;
+
+    void* result = current_;
+    current_ += size;
+    left_ -= size;
+    return result;
+}
+
+bool QGumboArena::addBlock(std::size_t minimumSize)
+{
+    const std::size_t blockSize = minimumSize > nextBlockSize_ ? alignedSize(minimumSize) : nextBlockSize_;
+    char* block = static_cast<char*>(std::malloc(blockSize));
+    //
+    // Called from gumbo's C code, so report failure the malloc way instead of throwing
+    //
+    if (!block)
+        return false;
+
+    blocks_.push_back(block);
+    current_ = block;
+    left_ = blockSize;
+
+    //
+    // Grow geometrically, so even big pages end up with a handful of blocks
+    //
+    if (nextBlockSize_ < MAX_BLOCK_SIZE)
+        nextBlockSize_ *= 2;
+
+    return true;
+}
+
+void* QGumboArena::gumboAllocate(void* arena, std::size_t size)
+{
+    return static_cast<QGumboArena*>(arena)->allocate(size);
+}
+
+void QGumboArena::gumboDeallocate(void* arena, void* ptr)
+{
+    UNUSED(arena);
+    UNUSED(ptr);
+}
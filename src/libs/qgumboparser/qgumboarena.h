@@ -0,0 +1,36 @@
+#ifndef QGUMBOARENA_H
+#define QGUMBOARENA_H
+
+#include <cstddef>
+#include <vector>
+
+//
+// Bump-pointer arena for gumbo allocations. Gumbo frees nodes one by one,
+// so the deallocator is a no-op and all memory is released with the arena.
+//
+class QGumboArena
+{
+public:
+    explicit QGumboArena(std::size_t initialBlockSize);
+    ~QGumboArena();
+
+    void* allocate(std::size_t size);
+
+    std::size_t blocksCount() const { return blocks_.size(); }
+
+    static void* gumboAllocate(void* arena, std::size_t size);
+    static void gumboDeallocate(void* arena, void* ptr);
+
+private:
+    QGumboArena(const QGumboArena&) = delete;
+    QGumboArena& operator=(const QGumboArena&) = delete;
+
+    bool addBlock(std::size_t minimumSize);
+
+    std::vector<char*> blocks_;
+    char* current_ = nullptr;
+    std::size_t left_ = 0;
+    std::size_t nextBlockSize_;
+};
+
+#endif // QGUMBOARENA_H
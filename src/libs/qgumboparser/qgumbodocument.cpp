@@ -1,8 +1,29 @@
 #include <QByteArray>
+#include <QHash>
 #include <QString>
+#include <QVector>
 #include <stdexcept>
 #include "qgumbodocument.h"
 #include "qgumbonode.h"
+#include "qgumboarena.h"
+
+namespace {
+
+//
+// Gumbo needs several times more memory than the source text takes,
+// so the first arena block is sized to fit most pages at once
+//
+const int ARENA_SIZE_FACTOR = 8;
+
+const char* const CLASS_ATTRIBUTE = "class";
+
+} /* namespace */
+
+struct QGumboIndex
+{
+    std::vector<QGumboNodes> byTag;
+    QHash<QString, QGumboNodes> byClass;
+};
 
 QGumboDocument QGumboDocument::parse(const char *utf8data)
 {
@@ -23,20 +44,35 @@ QGumboDocument QGumboDocument::parse(QByteArray data)
 }
 
 QGumboDocument::QGumboDocument(QByteArray arr) :
-    options_(&kGumboDefaultOptions),
     sourceData_(arr)
 {
+    arena_ = new QGumboArena(static_cast<std::size_t>(sourceData_.length()) * ARENA_SIZE_FACTOR);
+
+    GumboOptions* options = new GumboOptions(kGumboDefaultOptions);
+    options->allocator = &QGumboArena::gumboAllocate;
+    options->deallocator = &QGumboArena::gumboDeallocate;
+    options->userdata = arena_;
+    options_ = options;
+
     gumboOutput_ = gumbo_parse_with_options(options_,
                                             sourceData_.constData(),
                                             sourceData_.length());
-    if (!gumboOutput_)
+    if (!gumboOutput_) {
+        delete options_;
+        delete arena_;
         throw std::runtime_error("the data can't be parsed");
+    }
 }
 
 QGumboDocument::~QGumboDocument()
 {
-    if (gumboOutput_)
+    //
+    // The whole tree lives in the arena, so there is no need to walk it node by node
+    //
+    delete index_;
+    if (gumboOutput_ && !arena_)
         gumbo_destroy_output(options_, gumboOutput_);
+    delete arena_;
     if (options_ != &kGumboDefaultOptions)
         delete options_;
 }
@@ -44,13 +80,86 @@ QGumboDocument::~QGumboDocument()
 QGumboDocument::QGumboDocument(QGumboDocument &&source) :
     gumboOutput_(source.gumboOutput_),
     options_(source.options_),
+    arena_(source.arena_),
+    index_(source.index_),
     sourceData_(source.sourceData_)
 {
     source.gumboOutput_ = nullptr;
     source.options_ = nullptr;
+    source.arena_ = nullptr;
+    source.index_ = nullptr;
 }
 
 QGumboNode QGumboDocument::rootNode() const
 {
     return QGumboNode(gumboOutput_->root);
 }
+
+void QGumboDocument::buildIndex() const
+{
+    if (index_)
+        return;
+
+    index_ = new QGumboIndex;
+    index_->byTag.resize(GUMBO_TAG_LAST + 1);
+
+    //
+    // Walk the tree in document order with an explicit stack, so the lists
+    // come out in the same order as the recursive QGumboNode queries
+    //
+    std::vector<GumboNode*> stack;
+    stack.push_back(gumboOutput_->root);
+    QVector<QString> nodeClasses;
+    while (!stack.empty()) {
+        GumboNode* node = stack.back();
+        stack.pop_back();
+        if (!node || node->type != GUMBO_NODE_ELEMENT)
+            continue;
+
+        const GumboElement& element = node->v.element;
+        index_->byTag[element.tag].emplace_back(QGumboNode(node));
+
+        GumboAttribute* attr = gumbo_get_attribute(&element.attributes, CLASS_ATTRIBUTE);
+        if (attr) {
+            nodeClasses.clear();
+            const QString value = QString::fromUtf8(attr->value).toLower();
+            for (const QStringRef& part : value.splitRef(QChar(' '), QString::SkipEmptyParts)) {
+                const QString name = part.toString();
+                if (!nodeClasses.contains(name)) {
+                    nodeClasses.append(name);
+                    index_->byClass[name].emplace_back(QGumboNode(node));
+                }
+            }
+        }
+
+        for (uint i = element.children.length; i > 0; --i)
+            stack.push_back(static_cast<GumboNode*>(element.children.data[i - 1]));
+    }
+}
+
+const QGumboNodes& QGumboDocument::getElementsByTagName(HtmlTag tag) const
+{
+    buildIndex();
+
+    static const QGumboNodes empty;
+    const size_t tagIndex = static_cast<size_t>(tag);
+    if (tagIndex >= index_->byTag.size())
+        return empty;
+
+    return index_->byTag[tagIndex];
+}
+
+const QGumboNodes& QGumboDocument::getElementsByClassName(const QString& name) const
+{
+    if (name.isEmpty())
+        throw std::invalid_argument("class name can't be empty string");
+
+    buildIndex();
+
+    static const QGumboNodes empty;
+    const auto nodes = index_->byClass.constFind(name.toLower());
+    if (nodes == index_->byClass.constEnd())
+        return empty;
+
+    return nodes.value();
+}
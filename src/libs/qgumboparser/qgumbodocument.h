@@ -3,9 +3,11 @@
 
 #include <QByteArray>
 #include "gumbo-parser/src/gumbo.h"
+#include "qgumbonode.h"
 
 class QString;
-class QGumboNode;
+class QGumboArena;
+struct QGumboIndex;
 
 class QGumboDocument
 {
@@ -20,6 +22,15 @@ public:
 
     QGumboNode rootNode() const;
 
+    //
+    // Lookups over the whole document backed by an index of tags and classes.
+    // The index is built in one pass on the first query (or by buildIndex),
+    // after that every query costs only the number of matches.
+    //
+    void buildIndex() const;
+    const QGumboNodes& getElementsByTagName(HtmlTag) const;
+    const QGumboNodes& getElementsByClassName(const QString&) const;
+
 private:
     QGumboDocument(QByteArray);
 
@@ -28,6 +39,8 @@ private:
 
     GumboOutput *gumboOutput_ = nullptr;
     const GumboOptions *options_ = nullptr;
+    QGumboArena *arena_ = nullptr;
+    mutable QGumboIndex *index_ = nullptr;
     QByteArray sourceData_;
 };
 
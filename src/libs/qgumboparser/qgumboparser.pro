@@ -30,6 +30,8 @@ SOURCES += \
     qgumboattribute.cpp \
     qgumbodocument.cpp \
     qgumbonode.cpp \
+    qgumboarena.cpp \
+    qgumbotextextractor.cpp \
     gumbo-parser/src/attribute.c \
     gumbo-parser/src/char_ref.c \
     gumbo-parser/src/error.c \
@@ -46,6 +48,8 @@ HEADERS += \
     qgumboattribute.h \
     qgumbodocument.h \
     qgumbonode.h \
+    qgumboarena.h \
+    qgumbotextextractor.h \
     gumbo-parser/src/attribute.h \
     gumbo-parser/src/char_ref.h \
     gumbo-parser/src/error.h \
@@ -0,0 +1,181 @@
+#include "qgumbotextextractor.h"
+#include "gumbo-parser/src/gumbo.h"
+#include "gumbo-parser/src/parser.h"
+#include "gumbo-parser/src/tokenizer.h"
+
+namespace {
+
+const int FLUSH_SIZE = 16 * 1024;
+
+bool isSkippedTag(GumboTag tag)
+{
+    return tag == GUMBO_TAG_SCRIPT || tag == GUMBO_TAG_STYLE || tag == GUMBO_TAG_TEMPLATE;
+}
+
+bool isBlockTag(GumboTag tag)
+{
+    switch (tag) {
+    case GUMBO_TAG_ADDRESS: case GUMBO_TAG_ARTICLE: case GUMBO_TAG_ASIDE:
+    case GUMBO_TAG_BLOCKQUOTE: case GUMBO_TAG_BR: case GUMBO_TAG_CAPTION:
+    case GUMBO_TAG_DD: case GUMBO_TAG_DIV: case GUMBO_TAG_DL: case GUMBO_TAG_DT:
+    case GUMBO_TAG_FIGCAPTION: case GUMBO_TAG_FIGURE: case GUMBO_TAG_FOOTER:
+    case GUMBO_TAG_FORM: case GUMBO_TAG_H1: case GUMBO_TAG_H2: case GUMBO_TAG_H3:
+    case GUMBO_TAG_H4: case GUMBO_TAG_H5: case GUMBO_TAG_H6: case GUMBO_TAG_HEADER:
+    case GUMBO_TAG_HR: case GUMBO_TAG_LI: case GUMBO_TAG_MAIN: case GUMBO_TAG_NAV:
+    case GUMBO_TAG_OL: case GUMBO_TAG_OPTION: case GUMBO_TAG_P: case GUMBO_TAG_PRE:
+    case GUMBO_TAG_SECTION: case GUMBO_TAG_TABLE: case GUMBO_TAG_TD: case GUMBO_TAG_TH:
+    case GUMBO_TAG_TITLE: case GUMBO_TAG_TR: case GUMBO_TAG_UL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isWhitespace(int c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == 0xA0;
+}
+
+//
+// The tree builder normally switches the tokenizer into raw text modes,
+// without it contents of these elements would be tokenized as markup
+//
+void updateTokenizerState(GumboParser* parser, GumboTag tag)
+{
+    switch (tag) {
+    case GUMBO_TAG_SCRIPT:
+        gumbo_tokenizer_set_state(parser, GUMBO_LEX_SCRIPT);
+        break;
+    case GUMBO_TAG_STYLE: case GUMBO_TAG_XMP: case GUMBO_TAG_IFRAME:
+    case GUMBO_TAG_NOEMBED: case GUMBO_TAG_NOFRAMES:
+        gumbo_tokenizer_set_state(parser, GUMBO_LEX_RAWTEXT);
+        break;
+    case GUMBO_TAG_TITLE: case GUMBO_TAG_TEXTAREA:
+        gumbo_tokenizer_set_state(parser, GUMBO_LEX_RCDATA);
+        break;
+    case GUMBO_TAG_PLAINTEXT:
+        gumbo_tokenizer_set_state(parser, GUMBO_LEX_PLAINTEXT);
+        break;
+    default:
+        break;
+    }
+}
+
+void appendUtf8(QByteArray& buffer, int c)
+{
+    if (c < 0x80) {
+        buffer.append(static_cast<char>(c));
+    } else if (c < 0x800) {
+        buffer.append(static_cast<char>(0xC0 | (c >> 6)));
+        buffer.append(static_cast<char>(0x80 | (c & 0x3F)));
+    } else if (c < 0x10000) {
+        buffer.append(static_cast<char>(0xE0 | (c >> 12)));
+        buffer.append(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+        buffer.append(static_cast<char>(0x80 | (c & 0x3F)));
+    } else {
+        buffer.append(static_cast<char>(0xF0 | (c >> 18)));
+        buffer.append(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+        buffer.append(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+        buffer.append(static_cast<char>(0x80 | (c & 0x3F)));
+    }
+}
+
+} /* namespace */
+
+void QGumboTextExtractor::extract(const QByteArray& utf8html, const Sink& sink)
+{
+    //
+    // Tokenizer reports parse errors to the output, we don't need them
+    //
+    GumboOptions options = kGumboDefaultOptions;
+    options.max_errors = 0;
+    GumboOutput output;
+    output.errors = kGumboEmptyVector;
+
+    GumboParser parser;
+    parser._options = &options;
+    parser._output = &output;
+    parser._parser_state = nullptr;
+    gumbo_tokenizer_state_init(&parser, utf8html.constData(), utf8html.length());
+
+    QByteArray buffer;
+    buffer.reserve(FLUSH_SIZE + 4);
+    int skipDepth = 0;
+    bool hasText = false;
+    bool pendingSpace = false;
+
+    GumboToken token;
+    bool isEof = false;
+    while (!isEof) {
+        gumbo_lex(&parser, &token);
+        switch (token.type) {
+        case GUMBO_TOKEN_START_TAG: {
+            const GumboTag tag = token.v.start_tag.tag;
+            if (!token.v.start_tag.is_self_closing)
+                updateTokenizerState(&parser, tag);
+            if (isSkippedTag(tag)) {
+                if (!token.v.start_tag.is_self_closing)
+                    ++skipDepth;
+            } else if (isBlockTag(tag)) {
+                pendingSpace = hasText;
+            }
+            break;
+        }
+        case GUMBO_TOKEN_END_TAG: {
+            const GumboTag tag = token.v.end_tag;
+            if (isSkippedTag(tag)) {
+                if (skipDepth > 0)
+                    --skipDepth;
+            } else if (isBlockTag(tag)) {
+                pendingSpace = hasText;
+            }
+            break;
+        }
+        case GUMBO_TOKEN_WHITESPACE:
+        case GUMBO_TOKEN_CHARACTER:
+        case GUMBO_TOKEN_CDATA: {
+            if (skipDepth > 0)
+                break;
+
+            const int c = token.v.character;
+            if (isWhitespace(c)) {
+                pendingSpace = hasText;
+                break;
+            }
+
+            if (pendingSpace) {
+                buffer.append(' ');
+                pendingSpace = false;
+            }
+            appendUtf8(buffer, c);
+            hasText = true;
+
+            if (buffer.size() >= FLUSH_SIZE) {
+                sink(buffer.constData(), buffer.size());
+                buffer.clear();
+            }
+            break;
+        }
+        case GUMBO_TOKEN_EOF:
+            isEof = true;
+            break;
+        default:
+            break;
+        }
+        gumbo_token_destroy(&parser, &token);
+    }
+
+    if (!buffer.isEmpty())
+        sink(buffer.constData(), buffer.size());
+
+    gumbo_tokenizer_state_destroy(&parser);
+}
+
+QByteArray QGumboTextExtractor::extract(const QByteArray& utf8html)
+{
+    QByteArray text;
+    extract(utf8html, [&text] (const char* utf8data, int length) {
+        text.append(utf8data, length);
+    });
+    return text;
+}
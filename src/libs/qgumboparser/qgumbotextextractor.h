@@ -0,0 +1,21 @@
+#ifndef QGUMBOTEXTEXTRACTOR_H
+#define QGUMBOTEXTEXTRACTOR_H
+
+#include <QByteArray>
+#include <functional>
+
+//
+// Extracts plain text from html straight from the gumbo tokenizer, without building a DOM.
+// Contents of script, style and template elements are skipped, runs of whitespace and
+// boundaries of block elements are collapsed into single spaces. The output is UTF-8.
+//
+class QGumboTextExtractor
+{
+public:
+    typedef std::function<void(const char* utf8data, int length)> Sink;
+
+    static void extract(const QByteArray& utf8html, const Sink& sink);
+    static QByteArray extract(const QByteArray& utf8html);
+};
+
+#endif // QGUMBOTEXTEXTRACTOR_H
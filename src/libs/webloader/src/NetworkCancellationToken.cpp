@@ -0,0 +1,48 @@
+/*
+* Copyright (C) 2018 Dimka Novikov, to@dimkanovikov.pro
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3 of the License, or any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* Full license: http://dimkanovikov.pro/license/LGPLv3
+*/
+
+#include "NetworkCancellationToken.h"
+
+
+NetworkCancellationToken::NetworkCancellationToken() :
+    m_state(new NetworkCancellationTokenState, &QObject::deleteLater)
+{
+}
+
+void NetworkCancellationToken::cancel()
+{
+    if (m_state->isCancelled) {
+        return;
+    }
+
+    m_state->isCancelled = true;
+    emit m_state->cancelled();
+}
+
+bool NetworkCancellationToken::isCancelled() const
+{
+    return m_state->isCancelled;
+}
+
+QMetaObject::Connection NetworkCancellationToken::onCancelled(QObject* _context, std::function<void()> _handler) const
+{
+    if (m_state->isCancelled) {
+        _handler();
+        return QMetaObject::Connection();
+    }
+
+    return QObject::connect(m_state.data(), &NetworkCancellationTokenState::cancelled, _context, _handler);
+}
@@ -0,0 +1,78 @@
+/*
+* Copyright (C) 2018 Dimka Novikov, to@dimkanovikov.pro
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3 of the License, or any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* Full license: http://dimkanovikov.pro/license/LGPLv3
+*/
+
+#ifndef NETWORKCANCELLATIONTOKEN_H
+#define NETWORKCANCELLATIONTOKEN_H
+
+#include <QObject>
+#include <QSharedPointer>
+
+#include <functional>
+
+
+/**
+ * @brief Разделяемое состояние токена отмены
+ */
+class NetworkCancellationTokenState : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Отменена ли операция
+     */
+    bool isCancelled = false;
+
+signals:
+    /**
+     * @brief Операция отменена
+     */
+    void cancelled();
+};
+
+/**
+ * @brief Токен отмены сетевых запросов
+ *        Копии токена разделяют общее состояние, поэтому отменить операцию можно через любую из них
+ */
+class NetworkCancellationToken
+{
+public:
+    NetworkCancellationToken();
+
+    /**
+     * @brief Отменить операцию
+     */
+    void cancel();
+
+    /**
+     * @brief Отменена ли операция
+     */
+    bool isCancelled() const;
+
+    /**
+     * @brief Выполнить обработчик при отмене операции
+     * @note Если операция уже отменена, обработчик выполняется сразу
+     */
+    QMetaObject::Connection onCancelled(QObject* _context, std::function<void()> _handler) const;
+
+private:
+    /**
+     * @brief Состояние токена
+     */
+    QSharedPointer<NetworkCancellationTokenState> m_state;
+};
+
+#endif // NETWORKCANCELLATIONTOKEN_H
@@ -72,6 +72,26 @@ void NetworkQueue::stop(NetworkRequest* _request)
             m_requestParameters.removeAll(_request->m_requestParameters);
         }
     }
+
+    //
+    // А если запрос уже выполняется, то отменяем загрузку, не дожидаясь остановки загрузчика.
+    // Данные и ошибки отменённой загрузки запросу больше не нужны, а о завершении загрузчика
+    // он узнает как и раньше, чтобы ожидающие его не зависли
+    //
+    for (auto iter = m_loadingRequests.begin(); iter != m_loadingRequests.end(); ++iter) {
+        if (iter.value() == _request) {
+            WebLoader* loader = iter.key();
+            disconnect(loader, static_cast<void (WebLoader::*)(QByteArray, QUrl)>(&WebLoader::downloadComplete),
+                       _request, &NetworkRequest::downloadComplete);
+            disconnect(loader, static_cast<void (WebLoader::*)(int, QUrl)>(&WebLoader::uploadProgress),
+                       _request, &NetworkRequest::uploadProgress);
+            disconnect(loader, static_cast<void (WebLoader::*)(int, QUrl)>(&WebLoader::downloadProgress),
+                       _request, &NetworkRequest::downloadProgress);
+            disconnect(loader, &WebLoader::error, _request, &NetworkRequest::error);
+            disconnect(loader, &WebLoader::errorDetails, _request, &NetworkRequest::errorDetails);
+            loader->cancel();
+        }
+    }
 }
 
 void NetworkQueue::stopAll()
@@ -85,7 +105,7 @@ void NetworkQueue::stopAll()
     // Остановим уже обрабатывающиеся запросы
     //
     for (WebLoader* loader : m_busyLoaders) {
-        loader->stop();
+        loader->cancel();
     }
 }
 
@@ -132,6 +152,7 @@ void NetworkQueue::processQueue()
     //
     WebLoader* loader = m_freeLoaders.takeLast();
     m_busyLoaders.append(loader);
+    m_loadingRequests.insert(loader, requestEntry.request);
     //
     // ... конфигурируем его
     //
@@ -173,6 +194,7 @@ void NetworkQueue::reinitFinishedLoader()
     //
     const int loaderIndex = m_busyLoaders.indexOf(loader);
     const int invalidIndex = -1;
+    m_loadingRequests.remove(loader);
     if (loaderIndex != invalidIndex) {
         m_busyLoaders.takeAt(loaderIndex);
         m_freeLoaders.append(loader);
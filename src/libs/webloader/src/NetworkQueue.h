@@ -21,6 +21,7 @@
 #include "WebRequest.h"
 #include "WebRequestParameters.h"
 
+#include <QHash>
 #include <QObject>
 #include <QQueue>
 
@@ -60,7 +61,7 @@ public:
 
     /**
      * @brief Запросить остановку запроса
-     * @note Метод не гарантирует остановку запроса, если он уже выполняется, для этого стоит использовать stopAll
+     * @note Если запрос уже выполняется, то его загрузчик будет остановлен
      */
     void stop(NetworkRequest* _request);
 
@@ -109,6 +110,11 @@ private:
      */
     QVector<WebLoader*> m_busyLoaders;
 
+    /**
+     * @brief Запросы, выполняемые занятыми загрузчиками
+     */
+    QHash<WebLoader*, NetworkRequest*> m_loadingRequests;
+
     /**
      * @brief Объект очереди на загрузку
      */
@@ -72,6 +72,29 @@ int NetworkRequest::loadingTimeout() const
     return m_requestParameters.loadingTimeout();
 }
 
+void NetworkRequest::setCacheEnabled(bool _enabled)
+{
+    stop();
+    m_requestParameters.setCacheEnabled(_enabled);
+}
+
+bool NetworkRequest::isCacheEnabled() const
+{
+    return m_requestParameters.isCacheEnabled();
+}
+
+void NetworkRequest::setCancellationToken(const NetworkCancellationToken& _token)
+{
+    disconnect(m_cancellationConnection);
+    m_cancellationToken = _token;
+    m_cancellationConnection = m_cancellationToken.onCancelled(this, [this] { stop(); });
+}
+
+NetworkCancellationToken NetworkRequest::cancellationToken() const
+{
+    return m_cancellationToken;
+}
+
 void NetworkRequest::clearRequestAttributes()
 {
     stop();
@@ -114,6 +137,14 @@ void NetworkRequest::loadAsync(const QUrl& _urlToLoad, const QUrl& _referer)
     //
     NetworkQueue::instance()->stop(this);
 
+    //
+    // Если запрос уже отменён, то и выполнять его не нужно
+    //
+    if (m_cancellationToken.isCancelled()) {
+        done();
+        return;
+    }
+
     //
     // Настраиваем параметры и кладем в очередь
     //
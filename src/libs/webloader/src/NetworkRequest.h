@@ -18,6 +18,7 @@
 #ifndef NETWORKREQUEST_H
 #define NETWORKREQUEST_H
 
+#include "NetworkCancellationToken.h"
 #include "NetworkTypes.h"
 
 #include <QObject>
@@ -76,6 +77,27 @@ public:
      */
     int loadingTimeout() const;
 
+    /**
+     * @brief Установка возможности использования дискового кэша
+     * @note Кэш используется только если для него задана папка в WebCache
+     */
+    void setCacheEnabled(bool _enabled);
+
+    /**
+     * @brief Используется ли дисковый кэш
+     */
+    bool isCacheEnabled() const;
+
+    /**
+     * @brief Установить токен, при отмене которого запрос будет остановлен
+     */
+    void setCancellationToken(const NetworkCancellationToken& _token);
+
+    /**
+     * @brief Получить токен отмены запроса
+     */
+    NetworkCancellationToken cancellationToken() const;
+
     /**
      * @brief Очистить все старые атрибуты запроса
      */
@@ -117,6 +139,7 @@ public:
 
     /**
      * @brief Остановка выполнения запроса, связанного с текущим объектом
+     * @note Останавливает как ожидающий в очереди, так и уже выполняющийся запрос
      */
     void stop();
 
@@ -169,6 +192,16 @@ private:
      * @brief Загруженные данные в случае, если используется синхронная загрузка
      */
     QByteArray m_downloadedData;
+
+    /**
+     * @brief Токен отмены запроса
+     */
+    NetworkCancellationToken m_cancellationToken;
+
+    /**
+     * @brief Соединение с токеном отмены
+     */
+    QMetaObject::Connection m_cancellationConnection;
 };
 
 #endif // NETWORKREQUEST_H
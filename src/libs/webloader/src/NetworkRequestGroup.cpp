@@ -0,0 +1,172 @@
+/*
+* Copyright (C) 2018 Dimka Novikov, to@dimkanovikov.pro
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3 of the License, or any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* Full license: http://dimkanovikov.pro/license/LGPLv3
+*/
+
+#include "NetworkRequestGroup.h"
+#include "NetworkRequest.h"
+
+#include <QSharedPointer>
+
+#include <algorithm>
+
+
+NetworkRequestGroup::NetworkRequestGroup(int _maximumConcurrentRequests, QObject* _parent) :
+    QObject(_parent),
+    m_maximumConcurrentRequests(std::max(_maximumConcurrentRequests, 1))
+{
+}
+
+NetworkRequestGroup::~NetworkRequestGroup()
+{
+    //
+    // Запросы являются дочерними объектами группы и будут удалены вместе с ней,
+    // а при удалении они сами остановятся в очереди загрузки
+    //
+    m_pendingTasks.clear();
+}
+
+void NetworkRequestGroup::setMaximumConcurrentRequests(int _maximumConcurrentRequests)
+{
+    if (m_maximumConcurrentRequests == _maximumConcurrentRequests) {
+        return;
+    }
+
+    m_maximumConcurrentRequests = std::max(_maximumConcurrentRequests, 1);
+    processQueue();
+}
+
+int NetworkRequestGroup::maximumConcurrentRequests() const
+{
+    return m_maximumConcurrentRequests;
+}
+
+NetworkCancellationToken NetworkRequestGroup::cancellationToken() const
+{
+    return m_cancellationToken;
+}
+
+void NetworkRequestGroup::loadAsync(NetworkRequest* _request, const QUrl& _urlToLoad, Callback _callback,
+    const NetworkCancellationToken& _token)
+{
+    Q_ASSERT_X(_request, Q_FUNC_INFO, "NetworkRequest shouldn't be a null pointer");
+
+    _request->setParent(this);
+
+    Task task;
+    task.request = _request;
+    task.urlToLoad = _urlToLoad;
+    task.callback = _callback;
+    task.token = _token;
+    m_pendingTasks.enqueue(task);
+
+    processQueue();
+}
+
+void NetworkRequestGroup::cancel()
+{
+    const bool hasRunningRequests = m_runningRequests > 0;
+    const bool hasPendingTasks = !m_pendingTasks.isEmpty();
+
+    //
+    // Ожидающие запросы просто удаляем
+    //
+    while (!m_pendingTasks.isEmpty()) {
+        m_pendingTasks.dequeue().request->deleteLater();
+    }
+
+    //
+    // А выполняемые отменяем токеном, после чего группу можно использовать повторно
+    //
+    NetworkCancellationToken cancellationToken = m_cancellationToken;
+    m_cancellationToken = NetworkCancellationToken();
+    cancellationToken.cancel();
+
+    //
+    // Если выполняемых запросов не было, то и уведомить о завершении некому
+    //
+    if (!hasRunningRequests && hasPendingTasks) {
+        emit finished();
+    }
+}
+
+bool NetworkRequestGroup::isIdle() const
+{
+    return m_runningRequests == 0 && m_pendingTasks.isEmpty();
+}
+
+void NetworkRequestGroup::processQueue()
+{
+    while (m_runningRequests < m_maximumConcurrentRequests
+           && !m_pendingTasks.isEmpty()) {
+        const Task task = m_pendingTasks.dequeue();
+        NetworkRequest* request = task.request;
+        NetworkCancellationToken token = task.token;
+
+        //
+        // Запрос могли отменить, пока он ждал своей очереди
+        //
+        if (token.isCancelled()) {
+            request->deleteLater();
+            continue;
+        }
+
+        ++m_runningRequests;
+
+        //
+        // Отмена всей группы отменяет и каждый из запросов
+        //
+        m_cancellationToken.onCancelled(request, [token] () mutable { token.cancel(); });
+        request->setCancellationToken(token);
+
+        //
+        // Собираем результаты запроса
+        //
+        QSharedPointer<QByteArray> downloadedData(new QByteArray);
+        QSharedPointer<QString> lastError(new QString);
+        connect(request, static_cast<void (NetworkRequest::*)(QByteArray, QUrl)>(&NetworkRequest::downloadComplete),
+                this, [downloadedData] (const QByteArray& _data) { *downloadedData = _data; });
+        connect(request, &NetworkRequest::error, this, [lastError] (const QString& _error) { *lastError = _error; });
+
+        //
+        // Запрос завершается либо когда загрузчик закончит работу, либо сразу при отмене,
+        // т.к. отменённый запрос мог ещё не дойти до загрузчика
+        //
+        QSharedPointer<bool> isFinished(new bool(false));
+        const Callback callback = task.callback;
+        auto finishRequest = [this, request, downloadedData, lastError, callback, token, isFinished] {
+            if (*isFinished) {
+                return;
+            }
+            *isFinished = true;
+
+            request->disconnect(this);
+            request->deleteLater();
+            --m_runningRequests;
+
+            if (callback && !token.isCancelled()) {
+                callback(*downloadedData, *lastError);
+            }
+
+            processQueue();
+            if (isIdle()) {
+                emit finished();
+            }
+        };
+        connect(request, &NetworkRequest::finished, this, finishRequest);
+        token.onCancelled(request, finishRequest);
+
+        request->loadAsync(task.urlToLoad);
+    }
+}
@@ -0,0 +1,129 @@
+/*
+* Copyright (C) 2018 Dimka Novikov, to@dimkanovikov.pro
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3 of the License, or any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* Full license: http://dimkanovikov.pro/license/LGPLv3
+*/
+
+#ifndef NETWORKREQUESTGROUP_H
+#define NETWORKREQUESTGROUP_H
+
+#include "NetworkCancellationToken.h"
+
+#include <QObject>
+#include <QQueue>
+#include <QUrl>
+
+#include <functional>
+
+class NetworkRequest;
+
+
+/**
+ * @brief Группа асинхронных запросов с ограничением количества одновременно выполняемых
+ *        Результат каждого запроса передаётся в обработчик, вместо блокирующего ожидания loadSync
+ */
+class NetworkRequestGroup : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Обработчик результата запроса
+     * @param _data - загруженные данные
+     * @param _error - текст ошибки, пустой, если запрос выполнен успешно
+     */
+    using Callback = std::function<void(const QByteArray& _data, const QString& _error)>;
+
+public:
+    explicit NetworkRequestGroup(int _maximumConcurrentRequests = 1, QObject* _parent = nullptr);
+    ~NetworkRequestGroup();
+
+    /**
+     * @brief Установить максимальное количество одновременно выполняемых запросов
+     */
+    void setMaximumConcurrentRequests(int _maximumConcurrentRequests);
+
+    /**
+     * @brief Максимальное количество одновременно выполняемых запросов
+     */
+    int maximumConcurrentRequests() const;
+
+    /**
+     * @brief Токен отмены всех запросов группы
+     */
+    NetworkCancellationToken cancellationToken() const;
+
+    /**
+     * @brief Поставить запрос в очередь на выполнение
+     * @param _request - настроенный запрос, группа становится его владельцем
+     * @param _callback - обработчик результата, не вызывается, если запрос был отменён
+     * @param _token - токен для отмены конкретного запроса
+     */
+    void loadAsync(NetworkRequest* _request, const QUrl& _urlToLoad, Callback _callback = Callback(),
+        const NetworkCancellationToken& _token = NetworkCancellationToken());
+
+    /**
+     * @brief Отменить все выполняемые и ожидающие запросы
+     */
+    void cancel();
+
+    /**
+     * @brief Отсутствуют ли выполняемые и ожидающие запросы
+     */
+    bool isIdle() const;
+
+signals:
+    /**
+     * @brief Все запросы группы выполнены
+     */
+    void finished();
+
+private:
+    /**
+     * @brief Запустить ожидающие запросы, если есть свободные места
+     */
+    void processQueue();
+
+private:
+    /**
+     * @brief Запрос, ожидающий выполнения
+     */
+    struct Task {
+        NetworkRequest* request = nullptr;
+        QUrl urlToLoad;
+        Callback callback;
+        NetworkCancellationToken token;
+    };
+
+    /**
+     * @brief Ожидающие выполнения запросы
+     */
+    QQueue<Task> m_pendingTasks;
+
+    /**
+     * @brief Количество выполняемых в данный момент запросов
+     */
+    int m_runningRequests = 0;
+
+    /**
+     * @brief Максимальное количество одновременно выполняемых запросов
+     */
+    int m_maximumConcurrentRequests = 1;
+
+    /**
+     * @brief Токен отмены всех запросов группы
+     */
+    NetworkCancellationToken m_cancellationToken;
+};
+
+#endif // NETWORKREQUESTGROUP_H
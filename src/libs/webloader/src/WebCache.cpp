@@ -0,0 +1,450 @@
+/*
+* Copyright (C) 2018 Dimka Novikov, to@dimkanovikov.pro
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3 of the License, or any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* Full license: http://dimkanovikov.pro/license/LGPLv3
+*/
+
+#include "WebCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QLocale>
+#include <QMutexLocker>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace {
+    /**
+     * @brief Заголовки, используемые для кэширования
+     */
+    /** @{ */
+    const QByteArray kCacheControlHeader = "Cache-Control";
+    const QByteArray kETagHeader = "ETag";
+    const QByteArray kExpiresHeader = "Expires";
+    const QByteArray kLastModifiedHeader = "Last-Modified";
+    const QByteArray kIfNoneMatchHeader = "If-None-Match";
+    const QByteArray kIfModifiedSinceHeader = "If-Modified-Since";
+    /** @} */
+
+    /**
+     * @brief Размер кэша по-умолчанию, байт
+     */
+    const qint64 kDefaultMaximumCacheSize = 50 * 1024 * 1024;
+
+    /**
+     * @brief При переполнении кэш очищается до этой доли от максимального размера,
+     *        чтобы не запускать очистку при каждом сохранении
+     */
+    const qreal kExpireTargetRatio = 0.9;
+
+    /**
+     * @brief Название и версия файла индекса кэша
+     */
+    /** @{ */
+    const QString kIndexFileName = "index";
+    const quint32 kIndexVersion = 1;
+    /** @} */
+
+    /**
+     * @brief Расширение файлов с данными
+     */
+    const QString kDataFileExtension = ".data";
+
+    /**
+     * @brief Разобрать дату в формате http-заголовков
+     */
+    static QDateTime parseHttpDate(const QByteArray& _value) {
+        QDateTime date = QLocale::c().toDateTime(QString::fromLatin1(_value.trimmed()),
+                                                 "ddd, dd MMM yyyy hh:mm:ss 'GMT'");
+        date.setTimeSpec(Qt::UTC);
+        return date;
+    }
+
+    /**
+     * @brief Параметры кэширования из заголовка Cache-Control
+     */
+    struct CacheControl {
+        bool noStore = false;
+        bool noCache = false;
+        int maxAge = -1;
+    };
+
+    /**
+     * @brief Разобрать заголовок Cache-Control
+     */
+    static CacheControl parseCacheControl(const QByteArray& _value) {
+        CacheControl result;
+        for (const QByteArray& directive : _value.split(',')) {
+            const QByteArray trimmed = directive.trimmed().toLower();
+            if (trimmed == "no-store") {
+                result.noStore = true;
+            } else if (trimmed == "no-cache") {
+                //
+                // must-revalidate не учитываем, т.к. устаревшие записи и так всегда перепроверяются на сервере
+                //
+                result.noCache = true;
+            } else if (trimmed.startsWith("max-age=")) {
+                bool ok = false;
+                const int maxAge = trimmed.mid(int(qstrlen("max-age="))).toInt(&ok);
+                if (ok) {
+                    result.maxAge = maxAge;
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Определить дату, до которой ответ можно использовать без обращения к серверу
+     * @note Если сервер не сообщил срок свежести, ответ нужно перепроверять при каждом запросе
+     */
+    static QDateTime expirationDate(QNetworkReply* _reply) {
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        const CacheControl cacheControl = parseCacheControl(_reply->rawHeader(kCacheControlHeader));
+        if (cacheControl.noCache) {
+            return now;
+        }
+        if (cacheControl.maxAge >= 0) {
+            return now.addSecs(cacheControl.maxAge);
+        }
+        if (_reply->hasRawHeader(kExpiresHeader)) {
+            const QDateTime expires = parseHttpDate(_reply->rawHeader(kExpiresHeader));
+            if (expires.isValid()) {
+                return expires;
+            }
+        }
+        return now;
+    }
+}
+
+/**
+ * @brief Сериализация записей индекса кэша
+ * @note Объявлены вне анонимного пространства имён, чтобы их находили шаблоны QDataStream для QVector
+ */
+/** @{ */
+static QDataStream& operator<<(QDataStream& _stream, const WebCache::Entry& _entry)
+{
+    _stream << _entry.key << _entry.eTag << _entry.lastModified
+            << _entry.expirationDate << _entry.lastAccessDate << _entry.size;
+    return _stream;
+}
+
+static QDataStream& operator>>(QDataStream& _stream, WebCache::Entry& _entry)
+{
+    _stream >> _entry.key >> _entry.eTag >> _entry.lastModified
+            >> _entry.expirationDate >> _entry.lastAccessDate >> _entry.size;
+    return _stream;
+}
+/** @} */
+
+
+WebCache* WebCache::instance()
+{
+    static WebCache cache;
+    return &cache;
+}
+
+QString WebCache::cacheKey(const QUrl& _url, const QByteArray& _requestData)
+{
+    QString key = _url.toString(QUrl::RemoveFragment);
+    if (!_requestData.isEmpty()) {
+        key.append("#");
+        key.append(QCryptographicHash::hash(_requestData, QCryptographicHash::Sha1).toHex());
+    }
+    return key;
+}
+
+void WebCache::setCacheDirectory(const QString& _path)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_cacheDirectory == _path) {
+        return;
+    }
+
+    m_cacheDirectory = _path;
+    m_entries.clear();
+    m_currentCacheSize = 0;
+
+    if (!m_cacheDirectory.isEmpty()) {
+        QDir().mkpath(m_cacheDirectory);
+        loadIndex();
+    }
+}
+
+bool WebCache::isEnabled() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_cacheDirectory.isEmpty();
+}
+
+void WebCache::setMaximumCacheSize(qint64 _size)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_maximumCacheSize == _size) {
+        return;
+    }
+
+    m_maximumCacheSize = _size;
+    expire();
+    saveIndex();
+}
+
+WebCache::Entry WebCache::entry(const QString& _key)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.value(_key);
+}
+
+QByteArray WebCache::data(const QString& _key)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_entries.contains(_key)) {
+        return QByteArray();
+    }
+
+    QFile dataFile(dataFilePath(_key));
+    if (!dataFile.open(QIODevice::ReadOnly)) {
+        //
+        // Файл с данными пропал, значит и запись больше не нужна
+        //
+        removeUnlocked(_key);
+        saveIndex();
+        return QByteArray();
+    }
+
+    //
+    // Время обращения нужно только для очистки кэша, поэтому индекс из-за него не перезаписываем,
+    // он сохранится вместе со следующим изменением кэша, либо при завершении работы
+    //
+    m_entries[_key].lastAccessDate = QDateTime::currentDateTimeUtc();
+    m_isIndexChanged = true;
+
+    return dataFile.readAll();
+}
+
+void WebCache::prepareConditionalRequest(const QString& _key, QNetworkRequest& _request)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_entries.contains(_key)) {
+        return;
+    }
+
+    const Entry& entry = m_entries[_key];
+    if (!entry.eTag.isEmpty()) {
+        _request.setRawHeader(kIfNoneMatchHeader, entry.eTag);
+    }
+    if (!entry.lastModified.isEmpty()) {
+        _request.setRawHeader(kIfModifiedSinceHeader, entry.lastModified);
+    }
+}
+
+void WebCache::store(const QString& _key, QNetworkReply* _reply, const QByteArray& _data)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_cacheDirectory.isEmpty()) {
+        return;
+    }
+
+    //
+    // Кэшируем только успешные ответы, которые разрешено сохранять
+    // и которые либо свежи какое-то время, либо могут быть перепроверены на сервере
+    //
+    const int statusCode = _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const CacheControl cacheControl = parseCacheControl(_reply->rawHeader(kCacheControlHeader));
+    Entry newEntry;
+    newEntry.key = _key;
+    newEntry.eTag = _reply->rawHeader(kETagHeader);
+    newEntry.lastModified = _reply->rawHeader(kLastModifiedHeader);
+    newEntry.expirationDate = ::expirationDate(_reply);
+    newEntry.lastAccessDate = QDateTime::currentDateTimeUtc();
+    newEntry.size = _data.size();
+    const bool canBeRevalidated = !newEntry.eTag.isEmpty() || !newEntry.lastModified.isEmpty();
+    if (statusCode != 200
+        || cacheControl.noStore
+        || (!canBeRevalidated && !newEntry.isFresh())
+        || newEntry.size > m_maximumCacheSize) {
+        //
+        // Если ранее ответ был закэширован, то он больше не актуален
+        //
+        if (m_entries.contains(_key)) {
+            removeUnlocked(_key);
+            saveIndex();
+        }
+        return;
+    }
+
+    QSaveFile dataFile(dataFilePath(_key));
+    if (!dataFile.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    dataFile.write(_data);
+    if (!dataFile.commit()) {
+        return;
+    }
+
+    m_currentCacheSize -= m_entries.value(_key).size;
+    m_entries.insert(_key, newEntry);
+    m_currentCacheSize += newEntry.size;
+
+    expire();
+    saveIndex();
+}
+
+void WebCache::updateMetaData(const QString& _key, QNetworkReply* _reply)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_entries.contains(_key)) {
+        return;
+    }
+
+    Entry& entry = m_entries[_key];
+    if (_reply->hasRawHeader(kETagHeader)) {
+        entry.eTag = _reply->rawHeader(kETagHeader);
+    }
+    if (_reply->hasRawHeader(kLastModifiedHeader)) {
+        entry.lastModified = _reply->rawHeader(kLastModifiedHeader);
+    }
+    entry.expirationDate = ::expirationDate(_reply);
+    saveIndex();
+}
+
+void WebCache::remove(const QString& _key)
+{
+    QMutexLocker locker(&m_mutex);
+
+    removeUnlocked(_key);
+    saveIndex();
+}
+
+void WebCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (const QString& key : m_entries.keys()) {
+        QFile::remove(dataFilePath(key));
+    }
+    m_entries.clear();
+    m_currentCacheSize = 0;
+    saveIndex();
+}
+
+WebCache::~WebCache()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_isIndexChanged) {
+        saveIndex();
+    }
+}
+
+WebCache::WebCache() :
+    m_maximumCacheSize(kDefaultMaximumCacheSize)
+{
+}
+
+void WebCache::loadIndex()
+{
+    QFile indexFile(QDir(m_cacheDirectory).absoluteFilePath(kIndexFileName));
+    if (!indexFile.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&indexFile);
+    quint32 version = 0;
+    stream >> version;
+    if (version != kIndexVersion) {
+        return;
+    }
+
+    QVector<Entry> entries;
+    stream >> entries;
+    for (const Entry& entry : entries) {
+        //
+        // Записи, для которых потеряны данные, не восстанавливаем
+        //
+        if (!QFile::exists(dataFilePath(entry.key))) {
+            continue;
+        }
+
+        m_entries.insert(entry.key, entry);
+        m_currentCacheSize += entry.size;
+    }
+}
+
+void WebCache::saveIndex()
+{
+    if (m_cacheDirectory.isEmpty()) {
+        return;
+    }
+
+    m_isIndexChanged = false;
+
+    QSaveFile indexFile(QDir(m_cacheDirectory).absoluteFilePath(kIndexFileName));
+    if (!indexFile.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&indexFile);
+    stream << kIndexVersion;
+    stream << m_entries.values().toVector();
+    indexFile.commit();
+}
+
+QString WebCache::dataFilePath(const QString& _key) const
+{
+    const QByteArray hash = QCryptographicHash::hash(_key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QDir(m_cacheDirectory).absoluteFilePath(QString::fromLatin1(hash) + kDataFileExtension);
+}
+
+void WebCache::expire()
+{
+    if (m_currentCacheSize <= m_maximumCacheSize) {
+        return;
+    }
+
+    //
+    // Удаляем записи начиная с тех, к которым дольше всего не обращались
+    //
+    QVector<Entry> entries = m_entries.values().toVector();
+    std::sort(entries.begin(), entries.end(), [] (const Entry& _lhs, const Entry& _rhs) {
+        return _lhs.lastAccessDate < _rhs.lastAccessDate;
+    });
+    const qint64 targetCacheSize = m_maximumCacheSize * kExpireTargetRatio;
+    for (const Entry& entry : entries) {
+        if (m_currentCacheSize <= targetCacheSize) {
+            break;
+        }
+        removeUnlocked(entry.key);
+    }
+}
+
+void WebCache::removeUnlocked(const QString& _key)
+{
+    if (!m_entries.contains(_key)) {
+        return;
+    }
+
+    QFile::remove(dataFilePath(_key));
+    m_currentCacheSize -= m_entries.take(_key).size;
+}
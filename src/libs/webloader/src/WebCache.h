@@ -0,0 +1,219 @@
+/*
+* Copyright (C) 2018 Dimka Novikov, to@dimkanovikov.pro
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 3 of the License, or any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* Full license: http://dimkanovikov.pro/license/LGPLv3
+*/
+
+#ifndef WEBCACHE_H
+#define WEBCACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QUrl>
+
+class QNetworkReply;
+class QNetworkRequest;
+
+
+/**
+ * @brief Дисковый кэш http-ответов
+ *        Учитывает заголовки ETag/Last-Modified и Cache-Control, размер кэша ограничен,
+ *        при переполнении удаляются давно не использованные записи (LRU)
+ * Реализован как паттерн Singleton, т.к. используется всеми загрузчиками из разных потоков
+ */
+class WebCache
+{
+public:
+    /**
+     * @brief Метод, возвращающий указатель на инстанс класса
+     */
+    static WebCache* instance();
+
+    /**
+     * @brief Деструктор сохраняет индекс, если в нём остались несохранённые изменения
+     */
+    ~WebCache();
+
+    /**
+     * @brief Сформировать ключ записи в кэше для запроса
+     * @note Для POST-запросов в ключ добавляется хэш тела запроса
+     */
+    static QString cacheKey(const QUrl& _url, const QByteArray& _requestData = QByteArray());
+
+public:
+    /**
+     * @brief Запись кэша
+     */
+    struct Entry {
+        /**
+         * @brief Валидна ли запись
+         */
+        bool isValid() const { return !key.isEmpty(); }
+
+        /**
+         * @brief Можно ли использовать запись без обращения к серверу
+         */
+        bool isFresh() const { return expirationDate.isValid()
+                                      && expirationDate > QDateTime::currentDateTimeUtc(); }
+
+        /**
+         * @brief Ключ записи
+         */
+        QString key;
+
+        /**
+         * @brief Валидаторы ответа
+         */
+        /** @{ */
+        QByteArray eTag;
+        QByteArray lastModified;
+        /** @} */
+
+        /**
+         * @brief Дата, до которой ответ считается свежим
+         */
+        QDateTime expirationDate;
+
+        /**
+         * @brief Время последнего обращения к записи
+         */
+        QDateTime lastAccessDate;
+
+        /**
+         * @brief Размер тела ответа, байт
+         */
+        qint64 size = 0;
+    };
+
+    /**
+     * @brief Задать папку для хранения кэша
+     * @note Пока папка не задана, кэш отключён
+     */
+    void setCacheDirectory(const QString& _path);
+
+    /**
+     * @brief Включён ли кэш
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Установить максимальный размер кэша, байт
+     */
+    void setMaximumCacheSize(qint64 _size);
+
+    /**
+     * @brief Получить запись кэша по ключу
+     */
+    Entry entry(const QString& _key);
+
+    /**
+     * @brief Прочитать тело ответа, сохранённого в кэше
+     * @note Обновляет время последнего обращения к записи
+     */
+    QByteArray data(const QString& _key);
+
+    /**
+     * @brief Добавить в запрос заголовки для условного запроса (If-None-Match, If-Modified-Since)
+     */
+    void prepareConditionalRequest(const QString& _key, QNetworkRequest& _request);
+
+    /**
+     * @brief Сохранить ответ сервера в кэше, если это разрешено его заголовками
+     */
+    void store(const QString& _key, QNetworkReply* _reply, const QByteArray& _data);
+
+    /**
+     * @brief Обновить сроки хранения записи по ответу сервера 304 Not Modified
+     */
+    void updateMetaData(const QString& _key, QNetworkReply* _reply);
+
+    /**
+     * @brief Удалить запись из кэша
+     */
+    void remove(const QString& _key);
+
+    /**
+     * @brief Очистить кэш
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Приватные конструкторы и оператор присваивания
+     * Для реализации паттерна Singleton
+     */
+    WebCache();
+    WebCache(const WebCache&);
+    WebCache& operator=(const WebCache&);
+
+    /**
+     * @brief Загрузить индекс кэша с диска
+     */
+    void loadIndex();
+
+    /**
+     * @brief Сохранить индекс кэша на диск
+     */
+    void saveIndex();
+
+    /**
+     * @brief Путь к файлу с данными записи
+     */
+    QString dataFilePath(const QString& _key) const;
+
+    /**
+     * @brief Удалить давно не использованные записи, чтобы уложиться в ограничение по размеру
+     */
+    void expire();
+
+    /**
+     * @brief Удалить запись без блокировки мьютекса
+     */
+    void removeUnlocked(const QString& _key);
+
+private:
+    /**
+     * @brief Мьютекс для доступа к кэшу из потоков загрузчиков
+     */
+    mutable QMutex m_mutex;
+
+    /**
+     * @brief Папка для хранения кэша
+     */
+    QString m_cacheDirectory;
+
+    /**
+     * @brief Максимальный размер кэша, байт
+     */
+    qint64 m_maximumCacheSize;
+
+    /**
+     * @brief Текущий размер кэша, байт
+     */
+    qint64 m_currentCacheSize = 0;
+
+    /**
+     * @brief Индекс записей кэша
+     */
+    QHash<QString, Entry> m_entries;
+
+    /**
+     * @brief Есть ли в индексе изменения, которые ещё не записаны на диск
+     */
+    bool m_isIndexChanged = false;
+};
+
+#endif // WEBCACHE_H
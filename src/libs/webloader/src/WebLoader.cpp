@@ -16,6 +16,7 @@
 */
 
 #include "WebLoader.h"
+#include "WebCache.h"
 
 #include <QEventLoop>
 #include <QNetworkCookieJar>
@@ -33,6 +34,11 @@ namespace {
      */
     const int kPossibleRecievedMaxFileSize = 120000;
 
+    /**
+     * @brief Код ответа сервера, если закэшированные данные не изменились
+     */
+    const int kHttpNotModifiedCode = 304;
+
     /**
      * @brief Преобразовать ошибку в читаемый вид
      */
@@ -140,6 +146,30 @@ void WebLoader::run()
 
     m_requestSourceUrl = m_request.urlToLoad();
 
+    //
+    // Если для запроса можно использовать кэш и в нём есть свежий ответ, то к серверу не обращаемся вовсе
+    //
+    m_cacheKey.clear();
+    m_isCacheMissRefetched = false;
+    if (m_parameters.isCacheEnabled()
+        && WebCache::instance()->isEnabled()) {
+        const QByteArray requestData =
+                m_parameters.requestMethod() == NetworkRequestMethod::Post
+                ? m_request.multiPartData()
+                : QByteArray();
+        m_cacheKey = WebCache::cacheKey(m_requestSourceUrl, requestData);
+
+        if (WebCache::instance()->entry(m_cacheKey).isFresh()) {
+            m_downloadedData = WebCache::instance()->data(m_cacheKey);
+            if (!m_downloadedData.isEmpty()) {
+                emit uploadProgress(100, m_requestSourceUrl);
+                emit downloadProgress(100, m_requestSourceUrl);
+                emit downloadComplete(m_downloadedData, m_requestSourceUrl);
+                return;
+            }
+        }
+    }
+
     do
     {
         if (m_isNeedStop) {
@@ -156,13 +186,19 @@ void WebLoader::run()
 
             default:
             case NetworkRequestMethod::Get: {
-                const QNetworkRequest request = this->m_request.networkRequest();
+                QNetworkRequest request = this->m_request.networkRequest();
+                if (!m_cacheKey.isEmpty()) {
+                    WebCache::instance()->prepareConditionalRequest(m_cacheKey, request);
+                }
                 reply = m_networkManager->get(request);
                 break;
             }
 
             case NetworkRequestMethod::Post: {
-                const QNetworkRequest networkRequest = m_request.networkRequest(true);
+                QNetworkRequest networkRequest = m_request.networkRequest(true);
+                if (!m_cacheKey.isEmpty()) {
+                    WebCache::instance()->prepareConditionalRequest(m_cacheKey, networkRequest);
+                }
                 const QByteArray data = m_request.multiPartData();
                 reply = m_networkManager->post(networkRequest, data);
                 break;
@@ -191,12 +227,31 @@ void WebLoader::run()
         timeoutTimer.setSingleShot(true);
         timeoutTimer.start(m_parameters.loadingTimeout());
 
+        //
+        // Если загрузку отменили до входа в цикл обработки событий, то вызов quit() из cancel()
+        // потерян, поэтому проверяем флаг ещё раз, как только цикл запустится
+        //
+        QTimer::singleShot(0, &timeoutTimer, [this] {
+            if (m_isNeedStop) {
+                quit();
+            }
+        });
+
         //
         // Входим в поток обработки событий, ожидая завершения отработки networkManager'а
         //
         exec();
 
         if (m_isNeedStop) {
+            //
+            // Если загрузку отменили, то закрываем соединение сами, т.к. ждать завершения никто не будет
+            //
+            if (!reply.isNull()) {
+                m_networkManager->disconnect(this);
+                reply->disconnect(this);
+                reply->abort();
+                reply->deleteLater();
+            }
             return;
         }
 
@@ -224,6 +279,18 @@ void WebLoader::run()
     emit downloadComplete(m_downloadedData, m_requestSourceUrl);
 }
 
+void WebLoader::cancel()
+{
+    //
+    // Только выставляем флаг и прерываем цикл обработки событий потока,
+    // соединение закроется в самом потоке загрузки, поэтому вызывающего не блокируем
+    //
+    // ... если цикл ещё не запущен, то флаг будет проверен сразу после его запуска
+    //
+    m_isNeedStop = true;
+    quit();
+}
+
 void WebLoader::stop()
 {
     m_isNeedStop = true;
@@ -281,11 +348,38 @@ void WebLoader::downloadComplete(QNetworkReply* _reply)
         m_parameters.setRequestMethod(NetworkRequestMethod::Get); // Редирект всегда методом Get
         m_isNeedRedirect = true;
     } else {
+        const int statusCode = _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        //
+        // Если данные в кэше не изменились, то берём их оттуда
+        //
+        if (!m_cacheKey.isEmpty()
+            && statusCode == kHttpNotModifiedCode) {
+            WebCache::instance()->updateMetaData(m_cacheKey, _reply);
+            m_downloadedData = WebCache::instance()->data(m_cacheKey);
+            //
+            // ... а если данные успели удалить из кэша, то загружаем их заново, без условных заголовков
+            //
+            if (!WebCache::instance()->entry(m_cacheKey).isValid()
+                && !m_isCacheMissRefetched) {
+                m_isCacheMissRefetched = true;
+                m_isNeedRedirect = true;
+                _reply->deleteLater();
+                quit();
+                return;
+            }
+        }
         //! Загружены данные [reply->bytesAvailable()]
-        if (_reply->isOpen()) {
+        else if (_reply->isOpen()) {
             qint64 downloadedDataSize = _reply->bytesAvailable();
             QByteArray downloadedData = _reply->read(downloadedDataSize);
             m_downloadedData = downloadedData;
+
+            //
+            // ... и сохраняем в кэш, если это разрешено
+            //
+            if (!m_cacheKey.isEmpty()) {
+                WebCache::instance()->store(m_cacheKey, _reply, m_downloadedData);
+            }
         }
         _reply->deleteLater();
         m_isNeedRedirect = false;
@@ -25,6 +25,8 @@
 #include <QNetworkReply>
 #include <QThread>
 
+#include <atomic>
+
 class QNetworkAccessManager;
 class QNetworkCookieJar;
 
@@ -58,6 +60,13 @@ public:
     void loadAsync(const QUrl& _urlToLoad, const QUrl& _referer = QUrl());
     /** @} */
 
+    /**
+     * @brief Отменить выполнение, не дожидаясь остановки потока
+     * @note Данные загрузки после отмены не отправляются, поток завершится сам, как только
+     *       закроет соединение
+     */
+    void cancel();
+
     /**
      * @brief Остановить выполнение
      */
@@ -132,7 +141,7 @@ private:
     /**
      * @brief Необходимо ли остановить выполненеие процесса
      */
-    bool m_isNeedStop = false;
+    std::atomic<bool> m_isNeedStop{false};
 
     /**
      * @brief Собственно загрузчик, который делает всю черновую работу
@@ -164,6 +173,17 @@ private:
      * @brief Загруженные данные
      */
     QByteArray m_downloadedData;
+
+    /**
+     * @brief Ключ запроса в дисковом кэше
+     * @note Пустой, если кэш для запроса не используется
+     */
+    QString m_cacheKey;
+
+    /**
+     * @brief Был ли запрос повторён без условных заголовков из-за отсутствия данных в кэше
+     */
+    bool m_isCacheMissRefetched = false;
 };
 
 #endif // WEBLOADER_H
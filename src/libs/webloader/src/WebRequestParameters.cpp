@@ -52,6 +52,16 @@ int WebRequestParameters::loadingTimeout() const
     return m_loadingTimeout;
 }
 
+void WebRequestParameters::setCacheEnabled(bool _enabled)
+{
+    m_isCacheEnabled = _enabled;
+}
+
+bool WebRequestParameters::isCacheEnabled() const
+{
+    return m_isCacheEnabled;
+}
+
 bool operator==(const WebRequestParameters& _lhs, const WebRequestParameters& _rhs)
 {
     return &_lhs == &_rhs;
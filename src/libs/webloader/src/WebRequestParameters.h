@@ -60,6 +60,17 @@ public:
      */
     int loadingTimeout() const;
 
+    /**
+     * @brief Установка возможности использования дискового кэша для запроса
+     * @note По-умолчанию кэш не используется, т.к. большинство запросов к API не должны кэшироваться
+     */
+    void setCacheEnabled(bool _enabled);
+
+    /**
+     * @brief Можно ли использовать дисковый кэш для запроса
+     */
+    bool isCacheEnabled() const;
+
 private:
     /**
      * @brief Куки процесса
@@ -75,6 +86,11 @@ private:
      * @brief Таймаут загрузки ссылки, милисекунд
      */
     int m_loadingTimeout = 20000;
+
+    /**
+     * @brief Использовать ли дисковый кэш
+     */
+    bool m_isCacheEnabled = false;
 };
 
 /**
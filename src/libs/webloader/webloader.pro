@@ -39,7 +39,10 @@ HEADERS += \
     src/HttpMultiPart.h \
     src/NetworkQueue.h \
     src/WebRequestParameters.h \
-    src/NetworkTypes.h
+    src/NetworkTypes.h \
+    src/WebCache.h \
+    src/NetworkCancellationToken.h \
+    src/NetworkRequestGroup.h
 
 SOURCES += \
     src/NetworkRequest.cpp \
@@ -48,4 +51,7 @@ SOURCES += \
     src/WebLoader.cpp \
     src/HttpMultiPart.cpp \
     src/NetworkQueue.cpp \
-    src/WebRequestParameters.cpp
+    src/WebRequestParameters.cpp \
+    src/WebCache.cpp \
+    src/NetworkCancellationToken.cpp \
+    src/NetworkRequestGroup.cpp